@@ -1543,6 +1543,7 @@ QVector<int> JSCodeGen::generateJSCodeForFunctionsAndBindings(const QList<Compil
 
     qDeleteAll(_envMap);
     _envMap.clear();
+    _assignedNames.clear();
     return runtimeFunctionIndices;
 }
 
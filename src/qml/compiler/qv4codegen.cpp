@@ -139,6 +139,31 @@ void Codegen::ScanFunctions::checkName(const QStringRef &name, const SourceLocat
         }
     }
 }
+
+void Codegen::ScanFunctions::noteAssignment(ExpressionNode *target)
+{
+    if (IdentifierExpression *id = cast<IdentifierExpression *>(target))
+        _cg->_assignedNames.insert(id->name.toString());
+    else if (isArgumentsMember(target))
+        _env->argumentsObjectEscapes = true;
+}
+
+bool Codegen::ScanFunctions::isArgumentsMember(ExpressionNode *ast) const
+{
+    ExpressionNode *base = 0;
+    if (FieldMemberExpression *field = cast<FieldMemberExpression *>(ast))
+        base = field->base;
+    else if (ArrayMemberExpression *element = cast<ArrayMemberExpression *>(ast))
+        base = element->base;
+    IdentifierExpression *id = cast<IdentifierExpression *>(base);
+    return id && id->name == QLatin1String("arguments");
+}
+
+void Codegen::ScanFunctions::noteArgumentsRead()
+{
+    if (_env->usesArgumentsObject == Environment::ArgumentsObjectUnknown)
+        _env->usesArgumentsObject = Environment::ArgumentsObjectUsed;
+}
 void Codegen::ScanFunctions::checkForArguments(AST::FormalParameterList *parameters)
 {
     while (parameters) {
@@ -167,10 +192,16 @@ bool Codegen::ScanFunctions::visit(CallExpression *ast)
             if (id->name == QStringLiteral("eval")) {
                 if (_env->usesArgumentsObject == Environment::ArgumentsObjectUnknown)
                     _env->usesArgumentsObject = Environment::ArgumentsObjectUsed;
+                _env->argumentsObjectEscapes = true;
                 _env->hasDirectEval = true;
+                for (Environment *e = _env; e && !e->containsDirectEval; e = e->parent)
+                    e->containsDirectEval = true;
             }
         }
     }
+    // arguments[i]() passes the arguments object as this
+    if (isArgumentsMember(ast->base))
+        _env->argumentsObjectEscapes = true;
     int argc = 0;
     for (ArgumentList *it = ast->arguments; it; it = it->next)
         ++argc;
@@ -211,14 +242,19 @@ bool Codegen::ScanFunctions::visit(VariableDeclaration *ast)
     if (ast->name == QLatin1String("arguments"))
         _env->usesArgumentsObject = Environment::ArgumentsObjectNotUsed;
     _env->enter(ast->name.toString(), ast->expression ? Environment::VariableDefinition : Environment::VariableDeclaration);
+    if (ast->expression)
+        _cg->_assignedNames.insert(ast->name.toString());
     return true;
 }
 
 bool Codegen::ScanFunctions::visit(IdentifierExpression *ast)
 {
     checkName(ast->name, ast->identifierToken);
-    if (_env->usesArgumentsObject == Environment::ArgumentsObjectUnknown && ast->name == QLatin1String("arguments"))
-        _env->usesArgumentsObject = Environment::ArgumentsObjectUsed;
+    if (ast->name == QLatin1String("arguments")) {
+        if (_env->usesArgumentsObject == Environment::ArgumentsObjectUnknown)
+            _env->usesArgumentsObject = Environment::ArgumentsObjectUsed;
+        _env->argumentsObjectEscapes = true;
+    }
     return true;
 }
 
@@ -248,6 +284,87 @@ bool Codegen::ScanFunctions::visit(FunctionExpression *ast)
     return true;
 }
 
+bool Codegen::ScanFunctions::visit(BinaryExpression *ast)
+{
+    switch (ast->op) {
+    case QSOperator::Assign:
+    case QSOperator::InplaceAnd:
+    case QSOperator::InplaceSub:
+    case QSOperator::InplaceDiv:
+    case QSOperator::InplaceAdd:
+    case QSOperator::InplaceLeftShift:
+    case QSOperator::InplaceMod:
+    case QSOperator::InplaceMul:
+    case QSOperator::InplaceOr:
+    case QSOperator::InplaceRightShift:
+    case QSOperator::InplaceURightShift:
+    case QSOperator::InplaceXor:
+        noteAssignment(ast->left);
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+bool Codegen::ScanFunctions::visit(PreIncrementExpression *ast)
+{
+    noteAssignment(ast->expression);
+    return true;
+}
+
+bool Codegen::ScanFunctions::visit(PreDecrementExpression *ast)
+{
+    noteAssignment(ast->expression);
+    return true;
+}
+
+bool Codegen::ScanFunctions::visit(PostIncrementExpression *ast)
+{
+    noteAssignment(ast->base);
+    return true;
+}
+
+bool Codegen::ScanFunctions::visit(PostDecrementExpression *ast)
+{
+    noteAssignment(ast->base);
+    return true;
+}
+
+bool Codegen::ScanFunctions::visit(DeleteExpression *ast)
+{
+    if (isArgumentsMember(ast->expression))
+        _env->argumentsObjectEscapes = true;
+    return true;
+}
+
+// Reading arguments.length and arguments[i] does not need the arguments object, see
+// Codegen::readsArgumentsDirectly().
+bool Codegen::ScanFunctions::visit(FieldMemberExpression *ast)
+{
+    if (isArgumentsMember(ast) && ast->name == QLatin1String("length")) {
+        noteArgumentsRead();
+        return false;
+    }
+    return true;
+}
+
+bool Codegen::ScanFunctions::visit(ArrayMemberExpression *ast)
+{
+    if (isArgumentsMember(ast)) {
+        noteArgumentsRead();
+        Node::accept(ast->expression, this);
+        return false;
+    }
+    return true;
+}
+
+bool Codegen::ScanFunctions::visit(Catch *)
+{
+    _env->argumentsObjectEscapes = true;
+    return true;
+}
+
 void Codegen::ScanFunctions::enterFunction(FunctionExpression *ast, bool enterName, bool isExpression)
 {
     if (_env->isStrict && (ast->name == QLatin1String("eval") || ast->name == QLatin1String("arguments")))
@@ -308,6 +425,7 @@ bool Codegen::ScanFunctions::visit(WithStatement *ast)
         return false;
     }
 
+    _env->argumentsObjectEscapes = true;
     return true;
 }
 
@@ -343,6 +461,7 @@ bool Codegen::ScanFunctions::visit(LocalForStatement *ast) {
 }
 
 bool Codegen::ScanFunctions::visit(ForEachStatement *ast) {
+    noteAssignment(ast->initialiser);
     Node::accept(ast->initialiser, this);
     Node::accept(ast->expression, this);
 
@@ -353,6 +472,7 @@ bool Codegen::ScanFunctions::visit(ForEachStatement *ast) {
 }
 
 bool Codegen::ScanFunctions::visit(LocalForEachStatement *ast) {
+    _cg->_assignedNames.insert(ast->declaration->name.toString());
     Node::accept(ast->declaration, this);
     Node::accept(ast->expression, this);
 
@@ -424,6 +544,7 @@ Codegen::Codegen(bool strict)
     , _loop(0)
     , _labelledStatement(0)
     , _scopeAndFinally(0)
+    , _inliningCall(false)
     , _strictMode(strict)
     , _fileNameIsUrl(false)
     , hasError(false)
@@ -450,6 +571,7 @@ void Codegen::generateFromProgram(const QString &fileName,
     defineFunction(QStringLiteral("%entry"), node, 0, node->elements, inheritedLocals);
     qDeleteAll(_envMap);
     _envMap.clear();
+    _assignedNames.clear();
 }
 
 void Codegen::generateFromFunctionExpression(const QString &fileName,
@@ -471,6 +593,7 @@ void Codegen::generateFromFunctionExpression(const QString &fileName,
 
     qDeleteAll(_envMap);
     _envMap.clear();
+    _assignedNames.clear();
 }
 
 
@@ -1094,6 +1217,16 @@ bool Codegen::visit(ArrayMemberExpression *ast)
     if (hasError)
         return false;
 
+    if (readsArgumentsDirectly(ast->base)) {
+        Result index = expression(ast->expression);
+        if (hasError)
+            return false;
+        IR::ExprList *args = _function->New<IR::ExprList>();
+        args->init(argument(*index));
+        _expr.code = call(_block->NAME(IR::Name::builtin_get_argument, ast->lbracketToken.startLine, ast->lbracketToken.startColumn), args);
+        return false;
+    }
+
     Result base = expression(ast->base);
     Result index = expression(ast->expression);
     if (hasError)
@@ -1322,6 +1455,9 @@ bool Codegen::visit(CallExpression *ast)
     if (hasError)
         return false;
 
+    if (inlineCall(ast))
+        return false;
+
     Result base = expression(ast->base);
     IR::ExprList *args = 0, **args_it = &args;
     for (ArgumentList *it = ast->arguments; it; it = it->next) {
@@ -1339,6 +1475,116 @@ bool Codegen::visit(CallExpression *ast)
     return false;
 }
 
+namespace {
+class ContainsDelete: protected Visitor
+{
+public:
+    bool operator()(Node *node)
+    {
+        found = false;
+        Node::accept(node, this);
+        return found;
+    }
+
+protected:
+    using Visitor::visit;
+
+    virtual bool visit(DeleteExpression *)
+    {
+        found = true;
+        return false;
+    }
+
+private:
+    bool found;
+};
+} // anonymous namespace
+
+// Calls to a function declared in the calling function itself, whose body consists of a single
+// return statement, are replaced by the returned expression with the parameters bound to
+// temporaries. This avoids setting up a call context for small helpers such as
+// "function px(v) { return v * scale }". Free names in the callee resolve the same way from the
+// call site, as the callee's environment is nested directly in the caller's and has no members
+// of its own. The name must never be assigned to, so the call always reaches this declaration.
+// Code run by a direct eval in this function or a nested one can assign it, even in strict mode.
+bool Codegen::inlineCall(CallExpression *ast)
+{
+    if (_inliningCall || !_env->parent || _module->debugMode || _function->insideWithOrCatch
+            || _function->hasDirectEval || _env->containsDirectEval)
+        return false;
+
+    IdentifierExpression *base = cast<IdentifierExpression *>(ast->base);
+    if (!base)
+        return false;
+
+    const QString name = base->name.toString();
+    if (_assignedNames.contains(name) || (_function->isNamedExpression && *_function->name == name))
+        return false;
+
+    Environment::MemberMap::const_iterator member = _env->members.constFind(name);
+    if (member == _env->members.constEnd() || member->type != Environment::FunctionDefinition || !member->function)
+        return false;
+
+    FunctionExpression *callee = member->function;
+    Environment *calleeEnv = _envMap.value(callee);
+    if (!calleeEnv || !calleeEnv->members.isEmpty() || calleeEnv->hasDirectEval || calleeEnv->hasNestedFunctions
+            || calleeEnv->usesThis || calleeEnv->usesArgumentsObject == Environment::ArgumentsObjectUsed
+            || calleeEnv->isStrict != _env->isStrict)
+        return false;
+
+    SourceElements *elements = callee->body ? callee->body->elements : 0;
+    if (!elements || elements->next)
+        return false;
+    StatementSourceElement *element = cast<StatementSourceElement *>(elements->element);
+    ReturnStatement *returnStatement = element ? cast<ReturnStatement *>(element->statement) : 0;
+    if (!returnStatement || !returnStatement->expression)
+        return false;
+
+    // Deleting a parameter would behave differently once it is a temporary.
+    ContainsDelete containsDelete;
+    if (containsDelete(returnStatement->expression))
+        return false;
+
+    QHash<QString, unsigned> inlinedArguments;
+    ArgumentList *arg = ast->arguments;
+    for (FormalParameterList *formal = callee->formals; formal; formal = formal->next) {
+        const unsigned t = _block->newTemp();
+        if (arg) {
+            Result value = expression(arg->expression);
+            if (hasError)
+                return true;
+            move(_block->TEMP(t), *value);
+            arg = arg->next;
+        } else {
+            move(_block->TEMP(t), _block->CONST(IR::UndefinedType, 0));
+        }
+        inlinedArguments.insert(formal->name.toString(), t);
+    }
+    // Arguments without a matching parameter are still evaluated for their side effects.
+    for (; arg; arg = arg->next) {
+        statement(arg->expression);
+        if (hasError)
+            return true;
+    }
+
+    _function->maxNumberOfArguments = qMax(_function->maxNumberOfArguments, calleeEnv->maxNumberOfArguments);
+
+    qSwap(_inlinedArguments, inlinedArguments);
+    _inliningCall = true;
+    Result result = expression(returnStatement->expression);
+    _inliningCall = false;
+    qSwap(_inlinedArguments, inlinedArguments);
+    if (hasError)
+        return true;
+
+    const unsigned t = _block->newTemp();
+    move(_block->TEMP(t), *result);
+    IR::Temp *temp = _block->TEMP(t);
+    temp->isReadOnly = true; // the result of a call is not an lvalue
+    _expr.code = temp;
+    return true;
+}
+
 bool Codegen::visit(ConditionalExpression *ast)
 {
     if (hasError)
@@ -1441,12 +1687,30 @@ bool Codegen::visit(FieldMemberExpression *ast)
     if (hasError)
         return false;
 
+    if (ast->name == QLatin1String("length") && readsArgumentsDirectly(ast->base)) {
+        IR::ExprList *args = _function->New<IR::ExprList>();
+        // Builtin call arguments must be temps, the backends can't pass a string constant.
+        args->init(argument(_block->STRING(_function->newString(ast->name.toString()))));
+        _expr.code = call(_block->NAME(IR::Name::builtin_get_argument, ast->identifierToken.startLine, ast->identifierToken.startColumn), args);
+        return false;
+    }
+
     Result base = expression(ast->base);
     if (!hasError)
         _expr.code = member(*base, _function->newString(ast->name.toString()));
     return false;
 }
 
+// Functions that only read arguments.length and arguments[i] don't set up an arguments object. The
+// reads are done on the call data of the current context instead, which also keeps the function
+// from requiring a heap allocated context.
+bool Codegen::readsArgumentsDirectly(ExpressionNode *base) const
+{
+    IdentifierExpression *id = cast<IdentifierExpression *>(base);
+    return id && id->name == QLatin1String("arguments") && !_inliningCall && _env->parent
+            && _env->usesArgumentsObject == Environment::ArgumentsObjectUsed && !_function->usesArgumentsObject;
+}
+
 bool Codegen::visit(FunctionExpression *ast)
 {
     if (hasError)
@@ -1462,6 +1726,12 @@ IR::Expr *Codegen::identifier(const QString &name, int line, int col)
     if (hasError)
         return 0;
 
+    if (_inliningCall) {
+        QHash<QString, unsigned>::const_iterator it = _inlinedArguments.constFind(name);
+        if (it != _inlinedArguments.constEnd())
+            return _block->TEMP(*it);
+    }
+
     uint scope = 0;
     Environment *e = _env;
     IR::Function *f = _function;
@@ -2016,6 +2286,14 @@ int Codegen::defineFunction(const QString &name, AST::Node *ast,
     function->hasDirectEval = _env->hasDirectEval || _env->compilationMode == EvalCode
             || _module->debugMode; // Conditional breakpoints are like eval in the function
     function->usesArgumentsObject = _env->parent && (_env->usesArgumentsObject == Environment::ArgumentsObjectUsed);
+    if (function->usesArgumentsObject && !_env->argumentsObjectEscapes && !function->hasDirectEval) {
+        // Parameters are turned into temporaries when there is no arguments object, so reading
+        // the arguments directly only works as long as none of them is assigned to.
+        bool assignsToParameter = false;
+        for (FormalParameterList *it = formals; it && !assignsToParameter; it = it->next)
+            assignsToParameter = _assignedNames.contains(it->name.toString());
+        function->usesArgumentsObject = assignsToParameter;
+    }
     function->usesThis = _env->usesThis;
     function->maxNumberOfArguments = qMax(_env->maxNumberOfArguments, (int)QV4::Global::ReservedArgumentCount);
     function->isStrict = _env->isStrict;
@@ -51,6 +51,7 @@
 #include <private/qqmljsengine_p.h>
 #include <QtCore/QStringList>
 #include <QStack>
+#include <QtCore/QSet>
 #ifndef V4_BOOTSTRAP
 #include <qqmlerror.h>
 #endif
@@ -146,6 +147,8 @@ protected:
         AST::FormalParameterList *formals;
         int maxNumberOfArguments;
         bool hasDirectEval;
+        // Set when this environment or any nested function calls eval directly.
+        bool containsDirectEval;
         bool hasNestedFunctions;
         bool isStrict;
         bool isNamedFunctionExpression;
@@ -157,6 +160,9 @@ protected:
         };
 
         UsesArgumentsObject usesArgumentsObject;
+        // Set when the arguments object is used for anything but reading arguments.length and
+        // arguments[i], or could be reached through eval, with or catch.
+        bool argumentsObjectEscapes;
 
         CompilationMode compilationMode;
 
@@ -165,11 +171,13 @@ protected:
             , formals(0)
             , maxNumberOfArguments(0)
             , hasDirectEval(false)
+            , containsDirectEval(false)
             , hasNestedFunctions(false)
             , isStrict(false)
             , isNamedFunctionExpression(false)
             , usesThis(false)
             , usesArgumentsObject(ArgumentsObjectUnknown)
+            , argumentsObjectEscapes(false)
             , compilationMode(mode)
         {
             if (parent && parent->isStrict)
@@ -318,6 +326,8 @@ protected:
     void sourceElements(AST::SourceElements *ast);
     void variableDeclaration(AST::VariableDeclaration *ast);
     void variableDeclarationList(AST::VariableDeclarationList *ast);
+    bool inlineCall(AST::CallExpression *ast);
+    bool readsArgumentsDirectly(AST::ExpressionNode *base) const;
 
     QV4::IR::Expr *identifier(const QString &name, int line = 0, int col = 0);
     // Hook provided to implement QML lookup semantics
@@ -448,6 +458,9 @@ protected:
     ScopeAndFinally *_scopeAndFinally;
     QHash<AST::Node *, Environment *> _envMap;
     QHash<AST::FunctionExpression *, int> _functionMap;
+    QSet<QString> _assignedNames;
+    QHash<QString, unsigned> _inlinedArguments;
+    bool _inliningCall;
     QStack<QV4::IR::BasicBlock *> _exceptionHandlers;
     bool _strictMode;
 
@@ -478,6 +491,9 @@ protected:
         void checkDirectivePrologue(AST::SourceElements *ast);
 
         void checkName(const QStringRef &name, const AST::SourceLocation &loc);
+        void noteAssignment(AST::ExpressionNode *target);
+        bool isArgumentsMember(AST::ExpressionNode *ast) const;
+        void noteArgumentsRead();
         void checkForArguments(AST::FormalParameterList *parameters);
 
         virtual bool visit(AST::Program *ast);
@@ -490,6 +506,15 @@ protected:
         virtual bool visit(AST::IdentifierExpression *ast);
         virtual bool visit(AST::ExpressionStatement *ast);
         virtual bool visit(AST::FunctionExpression *ast);
+        virtual bool visit(AST::BinaryExpression *ast);
+        virtual bool visit(AST::PreIncrementExpression *ast);
+        virtual bool visit(AST::PreDecrementExpression *ast);
+        virtual bool visit(AST::PostIncrementExpression *ast);
+        virtual bool visit(AST::PostDecrementExpression *ast);
+        virtual bool visit(AST::DeleteExpression *ast);
+        virtual bool visit(AST::FieldMemberExpression *ast);
+        virtual bool visit(AST::ArrayMemberExpression *ast);
+        virtual bool visit(AST::Catch *ast);
 
         void enterFunction(AST::FunctionExpression *ast, bool enterName, bool isExpression = true);
 
@@ -442,6 +442,9 @@ struct Import
     Import(): type(0), uriIndex(0), qualifierIndex(0), majorVersion(0), minorVersion(0) {}
 };
 
+// Bump this whenever the layout of the compiled data changes.
+#define QV4_DATA_STRUCTURE_VERSION 0x02
+
 static const char magic_str[] = "qv4cdata";
 
 struct Unit
@@ -449,6 +452,8 @@ struct Unit
     char magic[8];
     qint16 architecture;
     qint16 version;
+    quint32 qtVersion;
+    char md5Checksum[16]; // checksum of the source (as UTF-16), all zero if not known
     quint32 unitSize; // Size of the Unit and any depending data.
 
     enum {
@@ -481,6 +486,13 @@ struct Unit
     quint32 offsetToObjects;
     quint32 indexOfRootObject;
 
+    // Units that were not generated by this build must not be used, as the layout may differ.
+    bool verifyHeader() const {
+        return memcmp(magic, magic_str, sizeof(magic)) == 0
+                && version == QV4_DATA_STRUCTURE_VERSION
+                && qtVersion == QT_VERSION;
+    }
+
     const Import *importAt(int idx) const {
         return reinterpret_cast<const Import*>((reinterpret_cast<const char *>(this)) + offsetToImports + idx * sizeof(Import));
     }
@@ -226,7 +226,8 @@ QV4::CompiledData::Unit *QV4::Compiler::JSUnitGenerator::generateUnit(GeneratorO
     memcpy(unit->magic, QV4::CompiledData::magic_str, sizeof(unit->magic));
     unit->architecture = 0; // ###
     unit->flags = QV4::CompiledData::Unit::IsJavascript;
-    unit->version = 1;
+    unit->version = QV4_DATA_STRUCTURE_VERSION;
+    unit->qtVersion = QT_VERSION;
     unit->unitSize = totalSize;
     unit->functionTableSize = irModule->functions.size();
     unit->offsetToFunctionTable = sizeof(*unit);
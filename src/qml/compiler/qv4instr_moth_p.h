@@ -112,6 +112,7 @@ QT_BEGIN_NAMESPACE
     F(CallBuiltinDefineArray, callBuiltinDefineArray) \
     F(CallBuiltinDefineObjectLiteral, callBuiltinDefineObjectLiteral) \
     F(CallBuiltinSetupArgumentsObject, callBuiltinSetupArgumentsObject) \
+    F(CallBuiltinGetArgument, callBuiltinGetArgument) \
     F(CallBuiltinConvertThisToObject, callBuiltinConvertThisToObject) \
     F(CreateValue, createValue) \
     F(CreateProperty, createProperty) \
@@ -570,6 +571,11 @@ union Instr
         MOTH_INSTR_HEADER
         Param result;
     };
+    struct instr_callBuiltinGetArgument {
+        MOTH_INSTR_HEADER
+        Param index;
+        Param result;
+    };
     struct instr_callBuiltinConvertThisToObject {
         MOTH_INSTR_HEADER
     };
@@ -833,6 +839,7 @@ union Instr
     instr_callBuiltinDefineArray callBuiltinDefineArray;
     instr_callBuiltinDefineObjectLiteral callBuiltinDefineObjectLiteral;
     instr_callBuiltinSetupArgumentsObject callBuiltinSetupArgumentsObject;
+    instr_callBuiltinGetArgument callBuiltinGetArgument;
     instr_callBuiltinConvertThisToObject callBuiltinConvertThisToObject;
     instr_createValue createValue;
     instr_createProperty createProperty;
@@ -1317,6 +1317,14 @@ void InstructionSelection::callBuiltinSetupArgumentObject(IR::Expr *result)
     addInstruction(call);
 }
 
+void InstructionSelection::callBuiltinGetArgument(IR::Expr *index, IR::Expr *result)
+{
+    Instruction::CallBuiltinGetArgument call;
+    call.index = getParam(index);
+    call.result = getResultParam(result);
+    addInstruction(call);
+}
+
 
 void QV4::Moth::InstructionSelection::callBuiltinConvertThisToObject()
 {
@@ -76,6 +76,8 @@ public:
 
     virtual void run(int functionIndex);
 
+    QByteArray codeForFunction(IR::Function *function) const { return codeRefs.value(function); }
+
 protected:
     virtual QQmlRefPointer<CompiledData::CompilationUnit> backendCompileStep();
 
@@ -105,6 +107,7 @@ protected:
     virtual void callBuiltinDefineArray(IR::Expr *result, IR::ExprList *args);
     virtual void callBuiltinDefineObjectLiteral(IR::Expr *result, int keyValuePairCount, IR::ExprList *keyValuePairs, IR::ExprList *arrayEntries, bool needSparseArray);
     virtual void callBuiltinSetupArgumentObject(IR::Expr *result);
+    virtual void callBuiltinGetArgument(IR::Expr *index, IR::Expr *result);
     virtual void callBuiltinConvertThisToObject();
     virtual void callValue(IR::Expr *value, IR::ExprList *args, IR::Expr *result);
     virtual void callQmlContextProperty(IR::Expr *base, IR::Member::MemberKind kind, int propertyIndex, IR::ExprList *args, IR::Expr *result);
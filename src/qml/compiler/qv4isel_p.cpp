@@ -421,6 +421,10 @@ void IRDecoder::callBuiltin(IR::Call *call, Expr *result)
         callBuiltinSetupArgumentObject(result);
         return;
 
+    case IR::Name::builtin_get_argument:
+        callBuiltinGetArgument(call->args->expr, result);
+        return;
+
     case IR::Name::builtin_convert_this_to_object:
         callBuiltinConvertThisToObject();
         return;
@@ -139,6 +139,7 @@ public: // to implement by subclasses:
     virtual void callBuiltinDefineArray(IR::Expr *result, IR::ExprList *args) = 0;
     virtual void callBuiltinDefineObjectLiteral(IR::Expr *result, int keyValuePairCount, IR::ExprList *keyValuePairs, IR::ExprList *arrayEntries, bool needSparseArray) = 0;
     virtual void callBuiltinSetupArgumentObject(IR::Expr *result) = 0;
+    virtual void callBuiltinGetArgument(IR::Expr *index, IR::Expr *result) = 0;
     virtual void callBuiltinConvertThisToObject() = 0;
     virtual void callValue(IR::Expr *value, IR::ExprList *args, IR::Expr *result) = 0;
     virtual void callQmlContextProperty(IR::Expr *base, IR::Member::MemberKind kind, int propertyIndex, IR::ExprList *args, IR::Expr *result) = 0;
@@ -339,6 +339,8 @@ const char *builtin_to_string(Name::Builtin b)
         return "builtin_define_object_literal";
     case IR::Name::builtin_setup_argument_object:
         return "builtin_setup_argument_object";
+    case IR::Name::builtin_get_argument:
+        return "builtin_get_argument";
     case IR::Name::builtin_convert_this_to_object:
         return "builtin_convert_this_to_object";
     case IR::Name::builtin_qml_context:
@@ -457,6 +459,53 @@ int Function::liveBasicBlocksCount() const
     return count;
 }
 
+// Returns true if the control flow graph of \a function has a cycle, which is the case when a
+// depth-first search from the entry block finds an edge to a block that is still on its stack.
+// Comparing block indices is not enough: code generation creates the join blocks of ifs, logical
+// operators and switches before their bodies, so plain forward control flow jumps to lower indices
+// as well.
+bool containsLoop(Function *function)
+{
+    if (function->basicBlockCount() == 0)
+        return false;
+
+    enum { Unvisited, OnStack, Finished };
+    QVector<int> state(function->basicBlockCount(), Unvisited);
+    // Each entry holds a block and the index of the next successor to visit. A block's exception
+    // handler is visited after its outgoing edges.
+    QVector<QPair<BasicBlock *, int> > stack;
+
+    BasicBlock *entry = function->basicBlock(0);
+    state[entry->index()] = OnStack;
+    stack.append(qMakePair(entry, 0));
+    while (!stack.isEmpty()) {
+        BasicBlock *bb = stack.last().first;
+        const int next = stack.last().second++;
+        BasicBlock *successor = 0;
+        if (next < bb->out.size()) {
+            successor = bb->out.at(next);
+        } else if (next == bb->out.size()) {
+            successor = bb->catchBlock;
+        } else {
+            state[bb->index()] = Finished;
+            stack.removeLast();
+            continue;
+        }
+
+        if (!successor || successor->isRemoved())
+            continue;
+        int &successorState = state[successor->index()];
+        if (successorState == OnStack)
+            return true;
+        if (successorState == Unvisited) {
+            successorState = OnStack;
+            stack.append(qMakePair(successor, 0));
+        }
+    }
+
+    return false;
+}
+
 void Function::removeSharedExpressions()
 {
     RemoveSharedExpressions removeSharedExpressions;
@@ -354,6 +354,7 @@ struct Name: Expr {
         builtin_define_array,
         builtin_define_object_literal,
         builtin_setup_argument_object,
+        builtin_get_argument,
         builtin_convert_this_to_object,
         builtin_qml_context,
         builtin_qml_imported_scripts_object
@@ -1069,6 +1070,8 @@ private:
     int _statementCount;
 };
 
+Q_QML_PRIVATE_EXPORT bool containsLoop(Function *function);
+
 class CloneExpr: protected IR::ExprVisitor
 {
 public:
@@ -41,6 +41,7 @@
 #include "qv4ssa_p.h"
 #include "qv4regalloc_p.h"
 #include "qv4assembler_p.h"
+#include "qv4vme_moth_p.h"
 
 #include <assembler/LinkBuffer.h>
 #include <WTFStubs.h>
@@ -67,8 +68,15 @@ void CompilationUnit::linkBackendToEngine(ExecutionEngine *engine)
     for (int i = 0 ;i < runtimeFunctions.size(); ++i) {
         const CompiledData::Function *compiledFunction = data->functionAt(i);
 
-        QV4::Function *runtimeFunction = new QV4::Function(engine, this, compiledFunction,
-                                                           (ReturnedValue (*)(QV4::ExecutionEngine *, const uchar *)) codeRefs[i].code().executableAddress());
+        QV4::Function *runtimeFunction;
+        const QByteArray byteCode = interpretedCode.value(i);
+        if (!byteCode.isEmpty()) {
+            runtimeFunction = new QV4::Function(engine, this, compiledFunction, &Moth::VME::exec);
+            runtimeFunction->codeData = reinterpret_cast<const uchar *>(interpretedCode.at(i).constData());
+        } else {
+            runtimeFunction = new QV4::Function(engine, this, compiledFunction,
+                                                (ReturnedValue (*)(QV4::ExecutionEngine *, const uchar *)) codeRefs[i].code().executableAddress());
+        }
         runtimeFunctions[i] = runtimeFunction;
     }
 }
@@ -372,6 +380,12 @@ Assembler::Jump Assembler::genTryDoubleConversion(IR::Expr *src, Assembler::FPRe
 
 Assembler::Jump Assembler::branchDouble(bool invertCondition, IR::AluOp op,
                                                    IR::Expr *left, IR::Expr *right)
+{
+    return branchDouble(invertCondition, op, toDoubleRegister(left, FPGpr0), toDoubleRegister(right, FPGpr1));
+}
+
+Assembler::Jump Assembler::branchDouble(bool invertCondition, IR::AluOp op,
+                                        FPRegisterID left, FPRegisterID right)
 {
     Assembler::DoubleCondition cond;
     switch (op) {
@@ -389,7 +403,7 @@ Assembler::Jump Assembler::branchDouble(bool invertCondition, IR::AluOp op,
     if (invertCondition)
         cond = JSC::MacroAssembler::invert(cond);
 
-    return JSC::MacroAssembler::branchDouble(cond, toDoubleRegister(left, FPGpr0), toDoubleRegister(right, FPGpr1));
+    return JSC::MacroAssembler::branchDouble(cond, left, right);
 }
 
 Assembler::Jump Assembler::branchInt32(bool invertCondition, IR::AluOp op, IR::Expr *left, IR::Expr *right)
@@ -86,6 +86,8 @@ struct CompilationUnit : public QV4::CompiledData::CompilationUnit
 
     QVector<JSC::MacroAssemblerCodeRef> codeRefs;
     QList<QVector<QV4::Primitive> > constantValues;
+    // Moth byte code of the functions that were not JIT compiled, empty for the others
+    QVector<QByteArray> interpretedCode;
 };
 
 struct RelativeCall {
@@ -387,6 +389,7 @@ public:
                                 IR::BasicBlock *falseBlock);
     Jump genTryDoubleConversion(IR::Expr *src, Assembler::FPRegisterID dest);
     Assembler::Jump branchDouble(bool invertCondition, IR::AluOp op, IR::Expr *left, IR::Expr *right);
+    Assembler::Jump branchDouble(bool invertCondition, IR::AluOp op, FPRegisterID left, FPRegisterID right);
     Assembler::Jump branchInt32(bool invertCondition, IR::AluOp op, IR::Expr *left, IR::Expr *right);
 
     Pointer loadAddress(RegisterID tmp, IR::Expr *t);
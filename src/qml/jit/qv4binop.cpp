@@ -563,4 +563,46 @@ Assembler::Jump Binop::genInlineBinop(IR::Expr *leftSource, IR::Expr *rightSourc
     return done;
 }
 
+static inline bool canBeNumber(IR::Expr *e)
+{
+    switch (e->type) {
+    case IR::DoubleType:
+    case IR::SInt32Type:
+    case IR::UInt32Type:
+    case IR::VarType:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Relational comparisons of operands whose type is not known statically (mostly values read from
+// properties) are in practice nearly always comparisons of numbers. Try comparing them as doubles
+// and branch straight to the target blocks. The same register considerations as for
+// genInlineBinop apply. Returns true if the caller still has to generate the runtime call for the
+// case where one of the operands turned out not to be a number.
+bool Binop::genInlineCompare(IR::Expr *leftSource, IR::Expr *rightSource,
+                             IR::BasicBlock *iftrue, IR::BasicBlock *iffalse)
+{
+    Q_ASSERT(op == IR::OpGt || op == IR::OpLt || op == IR::OpGe || op == IR::OpLe);
+
+    if (!canBeNumber(leftSource) || !canBeNumber(rightSource))
+        return true;
+
+    Assembler::FPRegisterID lReg = getFreeFPReg(rightSource, 2);
+    Assembler::FPRegisterID rReg = getFreeFPReg(leftSource, 4);
+    Assembler::Jump leftIsNoDbl = as->genTryDoubleConversion(leftSource, lReg);
+    Assembler::Jump rightIsNoDbl = as->genTryDoubleConversion(rightSource, rReg);
+
+    as->addPatch(iftrue, as->branchDouble(false, op, lReg, rReg));
+    as->addPatch(iffalse, as->jump());
+
+    if (leftIsNoDbl.isSet())
+        leftIsNoDbl.link(as);
+    if (rightIsNoDbl.isSet())
+        rightIsNoDbl.link(as);
+
+    return leftIsNoDbl.isSet() || rightIsNoDbl.isSet();
+}
+
 #endif
@@ -65,6 +65,8 @@ struct Binop {
     void doubleBinop(IR::Expr *lhs, IR::Expr *rhs, IR::Expr *target);
     bool int32Binop(IR::Expr *leftSource, IR::Expr *rightSource, IR::Expr *target);
     Assembler::Jump genInlineBinop(IR::Expr *leftSource, IR::Expr *rightSource, IR::Expr *target);
+    bool genInlineCompare(IR::Expr *leftSource, IR::Expr *rightSource,
+                          IR::BasicBlock *iftrue, IR::BasicBlock *iffalse);
 
     typedef Assembler::Jump (Binop::*MemRegOp)(Assembler::Address, Assembler::RegisterID);
     typedef Assembler::Jump (Binop::*ImmRegOp)(Assembler::TrustedImm32, Assembler::RegisterID);
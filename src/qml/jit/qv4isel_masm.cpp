@@ -43,6 +43,7 @@
 #include "qv4assembler_p.h"
 #include "qv4unop_p.h"
 #include "qv4binop_p.h"
+#include "qv4isel_moth_p.h"
 
 #include <QtCore/QBuffer>
 #include <QtCore/QCoreApplication>
@@ -269,6 +270,20 @@ InstructionSelection::~InstructionSelection()
 
 void InstructionSelection::run(int functionIndex)
 {
+    // Functions without loops, like most binding expressions, typically run only a few times.
+    // Compiling those to byte code is much cheaper than generating machine code for them.
+    static const bool jitOnlyLoops = !qEnvironmentVariableIsEmpty("QV4_JIT_ONLY_LOOPS");
+    if (jitOnlyLoops && !irModule->debugMode && !IR::containsLoop(irModule->functions[functionIndex])) {
+        if (!interpreterSelection) {
+            interpreterSelection.reset(new Moth::InstructionSelection(qmlEngine, executableAllocator, irModule, jsGenerator));
+            interpreterSelection->setUseFastLookups(useFastLookups);
+            compilationUnit->interpretedCode.resize(irModule->functions.size());
+        }
+        interpreterSelection->run(functionIndex);
+        compilationUnit->interpretedCode[functionIndex] = interpreterSelection->codeForFunction(irModule->functions[functionIndex]);
+        return;
+    }
+
     IR::Function *function = irModule->functions[functionIndex];
     qSwap(_function, function);
 
@@ -354,10 +369,14 @@ void InstructionSelection::run(int functionIndex)
     if (!_as->exceptionReturnLabel.isSet())
         visitRet(0);
 
-    int dummySize;
-    JSC::MacroAssemblerCodeRef codeRef =_as->link(&dummySize);
+    int codeSize;
+    JSC::MacroAssemblerCodeRef codeRef =_as->link(&codeSize);
     compilationUnit->codeRefs[functionIndex] = codeRef;
 
+    static const bool showCode = qEnvironmentVariableIsSet("QV4_SHOW_IR");
+    if (showCode)
+        qDebug("Generated %d bytes of code for function %s", codeSize, _function->name ? qPrintable(*_function->name) : "NO NAME");
+
     qSwap(_function, function);
     delete _as;
     _as = oldAssembler;
@@ -618,6 +637,12 @@ void InstructionSelection::callBuiltinSetupArgumentObject(IR::Expr *result)
     generateFunctionCall(result, Runtime::setupArgumentsObject, Assembler::EngineRegister);
 }
 
+void InstructionSelection::callBuiltinGetArgument(IR::Expr *index, IR::Expr *result)
+{
+    generateFunctionCall(result, Runtime::getArgument, Assembler::EngineRegister,
+                         Assembler::PointerToValue(index));
+}
+
 void InstructionSelection::callBuiltinConvertThisToObject()
 {
     generateFunctionCall(Assembler::Void, Runtime::convertThisToObject, Assembler::EngineRegister);
@@ -1452,6 +1477,11 @@ void InstructionSelection::visitCJump(IR::CJump *s)
             visitCJumpEqual(b, s->iftrue, s->iffalse);
             return;
         }
+        if (b->op >= IR::OpGt && b->op <= IR::OpLe) {
+            QV4::JIT::Binop binop(_as, b->op);
+            if (!binop.genInlineCompare(b->left, b->right, s->iftrue, s->iffalse))
+                return;
+        }
 
         Runtime::CompareOperation op = 0;
         Runtime::CompareOperationContext opContext = 0;
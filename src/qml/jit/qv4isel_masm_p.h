@@ -63,6 +63,10 @@
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
+namespace Moth {
+class InstructionSelection;
+}
+
 namespace JIT {
 
 class Q_QML_EXPORT InstructionSelection:
@@ -101,6 +105,7 @@ protected:
     virtual void callBuiltinDefineArray(IR::Expr *result, IR::ExprList *args);
     virtual void callBuiltinDefineObjectLiteral(IR::Expr *result, int keyValuePairCount, IR::ExprList *keyValuePairs, IR::ExprList *arrayEntries, bool needSparseArray);
     virtual void callBuiltinSetupArgumentObject(IR::Expr *result);
+    virtual void callBuiltinGetArgument(IR::Expr *index, IR::Expr *result);
     virtual void callBuiltinConvertThisToObject();
     virtual void callValue(IR::Expr *value, IR::ExprList *args, IR::Expr *result);
     virtual void callQmlContextProperty(IR::Expr *base, IR::Member::MemberKind kind, int propertyIndex, IR::ExprList *args, IR::Expr *result);
@@ -272,6 +277,7 @@ private:
 
     QScopedPointer<CompilationUnit> compilationUnit;
     QQmlEnginePrivate *qmlEngine;
+    QScopedPointer<Moth::InstructionSelection> interpreterSelection;
     RegisterInformation regularRegistersToSave;
     RegisterInformation fpRegistersToSave;
 };
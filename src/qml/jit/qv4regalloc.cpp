@@ -154,6 +154,7 @@ private:
     std::vector<std::vector<Use> > _uses;
     std::vector<int> _calls;
     std::vector<Hints> _hints;
+    std::vector<Const *> _constants;
 
     int usePosition(Stmt *s) const
     {
@@ -173,6 +174,7 @@ public:
         _uses.resize(function->tempCount);
         _calls.reserve(function->statementCount() / 3);
         _hints.resize(function->tempCount);
+        _constants.resize(function->tempCount);
 
         foreach (BasicBlock *bb, function->basicBlocks()) {
             _currentBB = bb;
@@ -197,6 +199,29 @@ public:
         return _defs[t.index].isPhiTarget;
     }
 
+    // Returns the constant that defines the temp, if it can be reloaded into a register by loading
+    // the constant again instead of reading it back from its spill slot.
+    Const *rematerializableConstant(const Temp &t) const
+    {
+        Q_ASSERT(_defs[t.index].isValid());
+        if (!_defs[t.index].canHaveReg)
+            return 0;
+        return _constants[t.index];
+    }
+
+    // A rematerializable temp whose uses all get a register never has to be read from its spill
+    // slot, so it doesn't need to be stored there either.
+    bool needsSpillStore(const Temp &t) const
+    {
+        if (!rematerializableConstant(t))
+            return true;
+        const std::vector<Use> &tempUses = _uses[t.index];
+        for (std::vector<Use>::const_iterator i = tempUses.begin(), ei = tempUses.end(); i != ei; ++i)
+            if (!i->mustHaveRegister())
+                return true;
+        return false;
+    }
+
     const std::vector<int> &calls() const { return _calls; }
     const Hints &hints(const Temp &t) const { return _hints[t.index]; }
     void addHint(const Temp &t, int physicalRegister)
@@ -289,6 +314,7 @@ protected: // IRDecoder
     virtual void callBuiltinDefineArray(IR::Expr *, IR::ExprList *) {}
     virtual void callBuiltinDefineObjectLiteral(IR::Expr *, int, IR::ExprList *, IR::ExprList *, bool) {}
     virtual void callBuiltinSetupArgumentObject(IR::Expr *) {}
+    virtual void callBuiltinGetArgument(IR::Expr *, IR::Expr *) {}
     virtual void callBuiltinConvertThisToObject() {}
 
     virtual void callValue(IR::Expr *value, IR::ExprList *args, IR::Expr *result)
@@ -454,9 +480,11 @@ protected: // IRDecoder
 
     virtual void loadConst(IR::Const *sourceConst, Expr *targetTemp)
     {
-        Q_UNUSED(sourceConst);
-
         addDef(targetTemp);
+
+        Temp *t = targetTemp->asTemp();
+        if (t && t->kind == Temp::VirtualRegister && t->type == sourceConst->type)
+            _constants[t->index] = sourceConst;
     }
 
     virtual void loadString(const QString &str, Expr *targetTemp)
@@ -809,6 +837,7 @@ class ResolutionPhase: protected StmtVisitor, protected ExprVisitor {
     LifeTimeIntervals::Ptr _intervals;
     QVector<LifeTimeInterval *> _unprocessed;
     IR::Function *_function;
+    const RegAllocInfo *_info;
     const std::vector<int> &_assignedSpillSlots;
     QHash<IR::Temp, const LifeTimeInterval *> _intervalForTemp;
     const QVector<const RegisterInfo *> &_intRegs;
@@ -818,6 +847,11 @@ class ResolutionPhase: protected StmtVisitor, protected ExprVisitor {
     QVector<Move *> _loads;
     QVector<Move *> _stores;
 
+    // Statistics for QV4_SHOW_IR:
+    int _spillStores;
+    int _stackReloads;
+    int _rematerializations;
+
     QHash<BasicBlock *, QList<const LifeTimeInterval *> > _liveAtStart;
     QHash<BasicBlock *, QList<const LifeTimeInterval *> > _liveAtEnd;
 
@@ -825,15 +859,20 @@ public:
     ResolutionPhase(const QVector<LifeTimeInterval *> &unprocessed,
                     const LifeTimeIntervals::Ptr &intervals,
                     IR::Function *function,
+                    const RegAllocInfo *info,
                     const std::vector<int> &assignedSpillSlots,
                     const QVector<const RegisterInfo *> &intRegs,
                     const QVector<const RegisterInfo *> &fpRegs)
         : _intervals(intervals)
         , _function(function)
+        , _info(info)
         , _assignedSpillSlots(assignedSpillSlots)
         , _intRegs(intRegs)
         , _fpRegs(fpRegs)
         , _currentStmt(0)
+        , _spillStores(0)
+        , _stackReloads(0)
+        , _rematerializations(0)
     {
         _unprocessed = unprocessed;
         _liveAtStart.reserve(function->basicBlockCount());
@@ -852,6 +891,10 @@ public:
         resolve();
     }
 
+    int spillStores() const { return _spillStores; }
+    int stackReloads() const { return _stackReloads; }
+    int rematerializations() const { return _rematerializations; }
+
 private:
     int defPosition(Stmt *s) const
     {
@@ -934,6 +977,9 @@ private:
         if (i->reg() == LifeTimeInterval::InvalidRegister)
             return;
 
+        if (!_info->needsSpillStore(i->temp()))
+            return;
+
         const RegisterInfo *pReg = platformRegister(*i);
         Q_ASSERT(pReg);
         int spillSlot = _assignedSpillSlots[i->temp().index];
@@ -1035,9 +1081,7 @@ private:
                             }
                         }
                         if (!moveFrom)
-                            moveFrom = createTemp(Temp::StackSlot,
-                                                  _assignedSpillSlots[t->index],
-                                    t->type);
+                            moveFrom = createReload(*t);
                     }
                 }
             } else {
@@ -1049,7 +1093,7 @@ private:
                         } else {
                             int spillSlot = _assignedSpillSlots[predIt->temp().index];
                             if (spillSlot != -1)
-                                moveFrom = createTemp(Temp::StackSlot, spillSlot, predIt->temp().type);
+                                moveFrom = createReload(predIt->temp());
                         }
                         break;
                     }
@@ -1100,6 +1144,7 @@ private:
                 if (spillSlot == RegisterAllocator::InvalidSpillSlot)
                     continue; // it has a life-time hole here.
                 moveTo = createTemp(Temp::StackSlot, spillSlot, it->temp().type);
+                ++_spillStores;
             } else {
                 moveTo = createPhysicalRegister(it, it->temp().type);
             }
@@ -1152,9 +1197,10 @@ private:
             return _intRegs.value(i.reg(), 0);
     }
 
-    Move *generateSpill(int spillSlot, Type type, int pReg) const
+    Move *generateSpill(int spillSlot, Type type, int pReg)
     {
         Q_ASSERT(spillSlot >= 0);
+        ++_spillStores;
 
         Move *store = _function->NewStmt<Move>();
         store->init(createTemp(Temp::StackSlot, spillSlot, type),
@@ -1162,14 +1208,28 @@ private:
         return store;
     }
 
-    Move *generateUnspill(const Temp &t, int pReg) const
+    // Values defined by a constant are rematerialized: loading the constant again is at least as
+    // cheap as reading the value back from the stack.
+    Expr *createReload(const Temp &t)
     {
-        Q_ASSERT(pReg >= 0);
+        if (Const *c = _info->rematerializableConstant(t)) {
+            Const *reload = _function->New<Const>();
+            reload->init(c->type, c->value);
+            ++_rematerializations;
+            return reload;
+        }
+
         int spillSlot = _assignedSpillSlots[t.index];
         Q_ASSERT(spillSlot != -1);
+        ++_stackReloads;
+        return createTemp(Temp::StackSlot, spillSlot, t.type);
+    }
+
+    Move *generateUnspill(const Temp &t, int pReg)
+    {
+        Q_ASSERT(pReg >= 0);
         Move *load = _function->NewStmt<Move>();
-        load->init(createTemp(Temp::PhysicalRegister, pReg, t.type),
-                   createTemp(Temp::StackSlot, spillSlot, t.type));
+        load->init(createTemp(Temp::PhysicalRegister, pReg, t.type), createReload(t));
         return load;
     }
 
@@ -1318,7 +1378,8 @@ void RegisterAllocator::run(IR::Function *function, const Optimizer &opt)
         dump(function);
 
     std::sort(_handled.begin(), _handled.end(), LifeTimeInterval::lessThan);
-    ResolutionPhase(_handled, _lifeTimeIntervals, function, _assignedSpillSlots, _normalRegisters, _fpRegisters).run();
+    ResolutionPhase resolution(_handled, _lifeTimeIntervals, function, _info.data(), _assignedSpillSlots, _normalRegisters, _fpRegisters);
+    resolution.run();
 
     function->tempCount = *std::max_element(_assignedSpillSlots.begin(), _assignedSpillSlots.end()) + 1;
 
@@ -1331,6 +1392,10 @@ void RegisterAllocator::run(IR::Function *function, const Optimizer &opt)
         buf.open(QIODevice::WriteOnly);
         QTextStream qout(&buf);
         IRPrinterWithRegisters(&qout, _lifeTimeIntervals, _registerInformation).print(function);
+        qout << "Spill slots: " << function->tempCount
+             << ", spill stores: " << resolution.spillStores()
+             << ", reloads from the stack: " << resolution.stackReloads()
+             << ", rematerialized constants: " << resolution.rematerializations() << endl;
         qDebug("%s", buf.data().constData());
     }
 }
@@ -60,6 +60,7 @@
 #include "qv4sequenceobject_p.h"
 #include "qv4qobjectwrapper_p.h"
 #include "qv4memberdata_p.h"
+#include "qv4lookup_p.h"
 #include "qv4arraybuffer_p.h"
 #include "qv4dataview_p.h"
 #include "qv4typedarray_p.h"
@@ -187,6 +188,7 @@ ExecutionEngine::ExecutionEngine(EvalISelFactory *factory)
     jsStackLimit = jsStackBase + JSStackLimit/sizeof(Value);
 
     identifierTable = new IdentifierTable(this);
+    lookupCache = new LookupCache;
 
     classPool = new InternalClassPool;
 
@@ -431,6 +433,7 @@ ExecutionEngine::~ExecutionEngine()
     delete m_multiplyWrappedQObjects;
     m_multiplyWrappedQObjects = 0;
     delete identifierTable;
+    delete lookupCache;
     delete memoryManager;
 
     QSet<QV4::CompiledData::CompilationUnit*> remainingUnits;
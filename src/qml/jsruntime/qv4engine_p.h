@@ -121,6 +121,7 @@ public:
     }
 
     IdentifierTable *identifierTable;
+    LookupCache *lookupCache;
 
     QV4::Debugging::Debugger *debugger;
     QV4::Profiling::Profiler *profiler;
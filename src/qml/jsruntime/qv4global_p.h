@@ -177,6 +177,7 @@ struct InternalClass;
 struct Property;
 struct Value;
 struct Lookup;
+struct LookupCache;
 struct ArrayData;
 struct VTable;
 
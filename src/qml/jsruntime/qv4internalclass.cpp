@@ -226,15 +226,7 @@ InternalClass *InternalClass::changeMember(Identifier *identifier, PropertyAttri
     if (t.lookup)
         return t.lookup;
 
-    // create a new class and add it to the tree
-    InternalClass *newClass = engine->emptyClass;
-    for (uint i = 0; i < size; ++i) {
-        if (i == idx) {
-            newClass = newClass->addMember(nameMap.at(i), data);
-        } else if (!propertyData.at(i).isEmpty()) {
-            newClass = newClass->addMember(nameMap.at(i), propertyData.at(i));
-        }
-    }
+    InternalClass *newClass = copyWithChangedMember(idx, data);
 
     t.lookup = newClass;
     Q_ASSERT(t.lookup);
@@ -305,22 +297,47 @@ InternalClass *InternalClass::addMemberImpl(Identifier *identifier, PropertyAttr
 
     // create a new class and add it to the tree
     InternalClass *newClass = engine->newClass(*this);
-    PropertyHash::Entry e = { identifier, newClass->size };
-    newClass->propertyTable.addEntry(e, newClass->size);
+    newClass->appendMember(identifier, data);
 
-    newClass->nameMap.add(newClass->size, identifier);
-    newClass->propertyData.add(newClass->size, data);
-    ++newClass->size;
+    t.lookup = newClass;
+    Q_ASSERT(t.lookup);
+    return newClass;
+}
+
+void InternalClass::appendMember(Identifier *identifier, PropertyAttributes data)
+{
+    PropertyHash::Entry e = { identifier, size };
+    propertyTable.addEntry(e, size);
+
+    nameMap.add(size, identifier);
+    propertyData.add(size, data);
+    ++size;
     if (data.isAccessor()) {
         // add a dummy entry, since we need two entries for accessors
-        newClass->propertyTable.addEntry(e, newClass->size);
-        newClass->nameMap.add(newClass->size, 0);
-        newClass->propertyData.add(newClass->size, PropertyAttributes());
-        ++newClass->size;
+        propertyTable.addEntry(e, size);
+        nameMap.add(size, 0);
+        propertyData.add(size, PropertyAttributes());
+        ++size;
     }
+}
 
-    t.lookup = newClass;
-    Q_ASSERT(t.lookup);
+// Builds a copy of this class in one go, with the member at changedIndex replaced by data,
+// or removed if data is empty. Rebuilding the class through addMember() transitions from the
+// empty class would create a new class for every member after the changed one, which for
+// large objects used as maps adds up to thousands of classes per delete. The copy hangs off
+// the transition that asked for it and is shared through that transition like any other class.
+InternalClass *InternalClass::copyWithChangedMember(uint changedIndex, PropertyAttributes data)
+{
+    InternalClass *newClass = new (engine->classPool) InternalClass(engine);
+    for (uint i = 0; i < size; ++i) {
+        if (i == changedIndex) {
+            if (!data.isEmpty())
+                newClass->appendMember(nameMap.at(i), data);
+        } else if (!propertyData.at(i).isEmpty()) {
+            newClass->appendMember(nameMap.at(i), propertyData.at(i));
+        }
+    }
+    newClass->extensible = extensible;
     return newClass;
 }
 
@@ -335,19 +352,10 @@ void InternalClass::removeMember(Object *object, Identifier *id)
 
     bool accessor = oldClass->propertyData.at(propIdx).isAccessor();
 
-    if (t.lookup) {
+    if (t.lookup)
         object->setInternalClass(t.lookup);
-    } else {
-        // create a new class and add it to the tree
-        InternalClass *newClass = oldClass->engine->emptyClass;
-        for (uint i = 0; i < oldClass->size; ++i) {
-            if (i == propIdx)
-                continue;
-            if (!oldClass->propertyData.at(i).isEmpty())
-                newClass = newClass->addMember(oldClass->nameMap.at(i), oldClass->propertyData.at(i));
-        }
-        object->setInternalClass(newClass);
-    }
+    else
+        object->setInternalClass(oldClass->copyWithChangedMember(propIdx, PropertyAttributes()));
 
     Q_ASSERT(object->internalClass()->size == oldClass->size - (accessor ? 2 : 1));
 
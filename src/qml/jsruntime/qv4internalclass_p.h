@@ -250,6 +250,8 @@ struct InternalClass : public QQmlJS::Managed {
 
 private:
     InternalClass *addMemberImpl(Identifier *identifier, PropertyAttributes data, uint *index);
+    void appendMember(Identifier *identifier, PropertyAttributes data);
+    InternalClass *copyWithChangedMember(uint changedIndex, PropertyAttributes data);
     friend struct ExecutionEngine;
     InternalClass(ExecutionEngine *engine);
     InternalClass(const InternalClass &other);
@@ -39,6 +39,64 @@ QT_BEGIN_NAMESPACE
 
 using namespace QV4;
 
+static ReturnedValue getCached(ExecutionEngine *engine, Lookup *l, const Object *o)
+{
+    Identifier *name = engine->current->compilationUnit->runtimeStrings[l->nameIndex]->identifier;
+    InternalClass *c = o->internalClass();
+    LookupCache::Entry *e = engine->lookupCache->entry(c, name);
+    if (e->internalClass == c && e->name == name) {
+        if (e->level == 0)
+            return o->propertyData(e->index)->asReturnedValue();
+        Heap::Object *p = o->prototype();
+        if (p && p->internalClass == e->prototypeClass)
+            return p->propertyData(e->index)->asReturnedValue();
+    }
+
+    Lookup probe = *l;
+    PropertyAttributes attrs;
+    ReturnedValue v = probe.lookup(o, &attrs);
+    if (v != Primitive::emptyValue().asReturnedValue() && attrs.isData() && probe.level <= 1) {
+        e->internalClass = c;
+        e->prototypeClass = probe.level == 1 ? probe.classList[1] : 0;
+        e->name = name;
+        e->index = probe.index;
+        e->level = probe.level;
+        e->writable = probe.level == 0 && attrs.isWritable();
+    }
+    return v;
+}
+
+static bool putCached(ExecutionEngine *engine, Lookup *l, Object *o, const Value &value)
+{
+    Identifier *name = engine->current->compilationUnit->runtimeStrings[l->nameIndex]->identifier;
+    InternalClass *c = o->internalClass();
+    LookupCache::Entry *e = engine->lookupCache->entry(c, name);
+    if (e->internalClass != c || e->name != name) {
+        uint idx = c->find(name);
+        if (idx == UINT_MAX)
+            return false;
+        PropertyAttributes attrs = c->propertyData.at(idx);
+        if (!attrs.isData() || !attrs.isWritable())
+            return false;
+
+        e->internalClass = c;
+        e->prototypeClass = 0;
+        e->name = name;
+        e->index = idx;
+        e->level = 0;
+        e->writable = true;
+    }
+    if (!e->writable)
+        return false;
+    // Plain objects can share the internal class of arrays, so the entry can't tell whether
+    // this is an array length, which needs the setter to truncate the array.
+    if (o->isArrayObject() && e->index == Heap::ArrayObject::LengthPropertyIndex)
+        return false;
+
+    *o->propertyData(e->index) = value;
+    return true;
+}
+
 
 ReturnedValue Lookup::lookup(const Value &thisObject, Object *o, PropertyAttributes *attrs)
 {
@@ -234,6 +292,15 @@ void Lookup::indexedSetterObjectInt(Lookup *l, const Value &object, const Value
             s->data(idx) = v;
             return;
         }
+        // appending to an array, as in a[a.length] = v, while there is room left
+        if (idx == s->len && idx < s->alloc && !s->attrs && o->isArrayObject()
+                && o->isExtensible() && !o->protoHasArray()) {
+            s->data(idx) = v;
+            s->len = idx + 1;
+            if (idx >= o->getLength())
+                o->setArrayLengthUnchecked(idx + 1);
+            return;
+        }
     }
     indexedSetterFallback(l, object, index, v);
 }
@@ -327,8 +394,52 @@ ReturnedValue Lookup::getterTwoClasses(Lookup *l, ExecutionEngine *engine, const
     return getterFallback(l, engine, object);
 }
 
+ReturnedValue Lookup::getterPolymorphic(Lookup *l, ExecutionEngine *engine, const Value &object)
+{
+    if (object.isManaged()) {
+        // we can safely cast to a QV4::Object here. If object is actually a string,
+        // the internal class won't match
+        Object *o = object.objectValue();
+        for (int i = 0; i < Size && l->classList[i]; ++i) {
+            if (l->classList[i] == o->internalClass())
+                return o->propertyData(l->indexList[i])->asReturnedValue();
+        }
+    }
+
+    if (const Object *o = object.as<Object>()) {
+        if (o->vtable()->get == Object::static_vtbl.get) {
+            Lookup probe = *l;
+            PropertyAttributes attrs;
+            ReturnedValue v = probe.lookup(o, &attrs);
+            if (v != Primitive::emptyValue().asReturnedValue()) {
+                int i = 0;
+                while (i < Size && l->classList[i])
+                    ++i;
+                if (i < Size && attrs.isData() && probe.level == 0) {
+                    l->classList[i] = probe.classList[0];
+                    l->indexList[i] = probe.index;
+                } else {
+                    l->getter = getterFallback;
+                }
+                return v;
+            }
+        }
+    }
+
+    l->getter = getterFallback;
+    return getterFallback(l, engine, object);
+}
+
 ReturnedValue Lookup::getterFallback(Lookup *l, ExecutionEngine *engine, const Value &object)
 {
+    if (const Object *o = object.as<Object>()) {
+        if (o->vtable()->get == Object::static_vtbl.get) {
+            ReturnedValue v = getCached(engine, l, o);
+            if (v != Primitive::emptyValue().asReturnedValue())
+                return v;
+        }
+    }
+
     QV4::Scope scope(engine);
     QV4::ScopedObject o(scope, object.toObject(scope.engine));
     if (!o)
@@ -392,8 +503,20 @@ ReturnedValue Lookup::getter0getter0(Lookup *l, ExecutionEngine *engine, const V
         if (l->classList[2] == o->internalClass())
             return o->propertyData(l->index2)->asReturnedValue();
     }
-    l->getter = getterFallback;
-    return getterFallback(l, engine, object);
+
+    // switch to the polymorphic getter, keeping the two classes seen so far
+    InternalClass *c0 = l->classList[0];
+    InternalClass *c1 = l->classList[2];
+    uint index0 = l->index;
+    uint index1 = l->index2;
+    l->classList[0] = c0;
+    l->classList[1] = c1;
+    l->classList[2] = 0;
+    l->classList[3] = 0;
+    l->indexList[0] = index0;
+    l->indexList[1] = index1;
+    l->getter = getterPolymorphic;
+    return getterPolymorphic(l, engine, object);
 }
 
 ReturnedValue Lookup::getter0getter1(Lookup *l, ExecutionEngine *engine, const Value &object)
@@ -742,6 +865,11 @@ void Lookup::setterTwoClasses(Lookup *l, ExecutionEngine *engine, Value &object,
 
 void Lookup::setterFallback(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value)
 {
+    if (Object *o = object.as<Object>()) {
+        if (o->vtable()->put == Object::static_vtbl.put && putCached(engine, l, o, value))
+            return;
+    }
+
     QV4::Scope scope(engine);
     QV4::ScopedObject o(scope, object.toObject(scope.engine));
     if (o) {
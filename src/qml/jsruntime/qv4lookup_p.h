@@ -77,6 +77,7 @@ struct Lookup {
     union {
         int level;
         uint index2;
+        uint indexList[Size];
     };
     uint index;
     uint nameIndex;
@@ -91,6 +92,7 @@ struct Lookup {
 
     static ReturnedValue getterGeneric(Lookup *l, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterTwoClasses(Lookup *l, ExecutionEngine *engine, const Value &object);
+    static ReturnedValue getterPolymorphic(Lookup *l, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterFallback(Lookup *l, ExecutionEngine *engine, const Value &object);
 
     static ReturnedValue getter0(Lookup *l, ExecutionEngine *engine, const Value &object);
@@ -132,6 +134,30 @@ struct Lookup {
 
 };
 
+// Engine wide cache for the property accesses that have gone through too many internal
+// classes to be handled by the lookup itself. Entries are keyed by the internal class of
+// the object and the name of the property, and describe data properties of the object
+// itself or of its prototype.
+struct LookupCache {
+    enum { Size = 1024 };
+
+    struct Entry {
+        InternalClass *internalClass;
+        InternalClass *prototypeClass;
+        Identifier *name;
+        uint index;
+        uint level : 1;
+        uint writable : 1;
+    };
+
+    LookupCache() { memset(entries, 0, sizeof(entries)); }
+
+    Entry *entry(InternalClass *c, Identifier *name)
+    { return entries + (((quintptr(c) ^ quintptr(name)) >> 4) & (Size - 1)); }
+
+    Entry entries[Size];
+};
+
 }
 
 QT_END_NAMESPACE
@@ -505,6 +505,26 @@ static Heap::String *convert_to_string_add(ExecutionEngine *engine, const Value
     } // switch
 }
 
+// Appending a short flat string to a rope whose right child is also short
+// and flat merges the two into a new flat tail instead of adding another
+// level. This keeps the ropes built by loops appending small pieces one at
+// a time shallow, while the copies stay bounded by ShortTailLength.
+static Heap::String *concatStrings(ExecutionEngine *engine, Heap::String *left, Heap::String *right)
+{
+    static const uint ShortTailLength = 64;
+
+    MemoryManager *mm = engine->memoryManager;
+    if (left->largestSubLength && !right->largestSubLength) {
+        Heap::String *tail = left->right;
+        if (!tail->largestSubLength && tail->len + right->len <= ShortTailLength) {
+            Scope scope(engine);
+            ScopedString merged(scope, engine->newString(tail->toQString() + right->toQString()));
+            return mm->alloc<String>(mm, left->left, merged->d());
+        }
+    }
+    return mm->alloc<String>(mm, left, right);
+}
+
 QV4::ReturnedValue RuntimeHelpers::addHelper(ExecutionEngine *engine, const Value &left, const Value &right)
 {
     Scope scope(engine);
@@ -522,8 +542,7 @@ QV4::ReturnedValue RuntimeHelpers::addHelper(ExecutionEngine *engine, const Valu
             return pright->asReturnedValue();
         if (!pright->stringValue()->d()->length())
             return pleft->asReturnedValue();
-        MemoryManager *mm = engine->memoryManager;
-        return (mm->alloc<String>(mm, pleft->stringValue()->d(), pright->stringValue()->d()))->asReturnedValue();
+        return concatStrings(engine, pleft->stringValue()->d(), pright->stringValue()->d())->asReturnedValue();
     }
     double x = RuntimeHelpers::toNumber(pleft);
     double y = RuntimeHelpers::toNumber(pright);
@@ -539,8 +558,7 @@ QV4::ReturnedValue Runtime::addString(ExecutionEngine *engine, const Value &left
             return right.asReturnedValue();
         if (!right.stringValue()->d()->length())
             return left.asReturnedValue();
-        MemoryManager *mm = engine->memoryManager;
-        return (mm->alloc<String>(mm, left.stringValue()->d(), right.stringValue()->d()))->asReturnedValue();
+        return concatStrings(engine, left.stringValue()->d(), right.stringValue()->d())->asReturnedValue();
     }
 
     Scope scope(engine);
@@ -557,8 +575,7 @@ QV4::ReturnedValue Runtime::addString(ExecutionEngine *engine, const Value &left
         return pright->asReturnedValue();
     if (!pright->stringValue()->d()->length())
         return pleft->asReturnedValue();
-    MemoryManager *mm = engine->memoryManager;
-    return (mm->alloc<String>(mm, pleft->stringValue()->d(), pright->stringValue()->d()))->asReturnedValue();
+    return concatStrings(engine, pleft->stringValue()->d(), pright->stringValue()->d())->asReturnedValue();
 }
 
 void Runtime::setProperty(ExecutionEngine *engine, const Value &object, int nameIndex, const Value &value)
@@ -1283,6 +1300,41 @@ QV4::ReturnedValue Runtime::setupArgumentsObject(ExecutionEngine *engine)
     return engine->memoryManager->allocObject<ArgumentsObject>(ic, engine->objectPrototype(), c)->asReturnedValue();
 }
 
+// Functions that only read arguments.length and arguments[i] don't create an arguments object,
+// all reads go through here instead. The object would have the arguments, length and callee (or
+// the throwing callee and caller accessors in strict mode) as own properties, everything else
+// comes from the object prototype.
+QV4::ReturnedValue Runtime::getArgument(ExecutionEngine *engine, const Value &index)
+{
+    Q_ASSERT(engine->current->type >= Heap::ExecutionContext::Type_SimpleCallContext);
+    Heap::CallContext *c = static_cast<Heap::CallContext *>(engine->current);
+    CallData *callData = c->callData;
+
+    uint idx = index.asArrayIndex();
+    if (idx < static_cast<uint>(callData->argc))
+        return callData->args[idx].asReturnedValue();
+
+    Scope scope(engine);
+    ScopedString name(scope, index.toString(engine));
+    if (scope.hasException())
+        return Encode::undefined();
+    if (name->equals(engine->id_length()))
+        return Encode(callData->argc);
+    idx = name->asArrayIndex();
+    if (idx < static_cast<uint>(callData->argc))
+        return callData->args[idx].asReturnedValue();
+    if (c->strictMode) {
+        if (name->equals(engine->id_callee()) || name->equals(engine->id_caller()))
+            return engine->throwTypeError();
+    } else if (name->equals(engine->id_callee())) {
+        return c->function->asReturnedValue();
+    }
+    if (name->equals(engine->id___proto__()))
+        return engine->objectPrototype()->asReturnedValue();
+
+    return engine->objectPrototype()->get(name);
+}
+
 #endif // V4_BOOTSTRAP
 
 QV4::ReturnedValue Runtime::increment(const Value &value)
@@ -151,6 +151,7 @@ struct Q_QML_PRIVATE_EXPORT Runtime {
     // function header
     static void declareVar(ExecutionEngine *engine, bool deletable, int nameIndex);
     static ReturnedValue setupArgumentsObject(ExecutionEngine *engine);
+    static ReturnedValue getArgument(ExecutionEngine *engine, const Value &index);
     static void convertThisToObject(ExecutionEngine *engine);
 
     // literals
@@ -33,6 +33,7 @@
 #include "qv4typedarray_p.h"
 #include "qv4arraybuffer_p.h"
 #include "qv4string_p.h"
+#include "qv4arraydata_p.h"
 
 #include <cmath>
 
@@ -70,6 +71,25 @@ void UInt8ArrayWrite(ExecutionEngine *e, char *data, int index, const Value &val
     data[index] = v;
 }
 
+static inline unsigned char clampToUInt8(double d)
+{
+    // ### is there a way to optimise this?
+    if (d <= 0 || std::isnan(d))
+        return 0;
+    if (d >= 255)
+        return 255;
+    double f = std::floor(d);
+    if (f + 0.5 < d)
+        return (unsigned char)(f + 1);
+    if (d < f + 0.5)
+        return (unsigned char)(f);
+    if (int(f) % 2) {
+        // odd number
+        return (unsigned char)(f + 1);
+    }
+    return (unsigned char)(f);
+}
+
 void UInt8ClampedArrayWrite(ExecutionEngine *e, char *data, int index, const Value &value)
 {
     if (value.isInteger()) {
@@ -79,30 +99,7 @@ void UInt8ClampedArrayWrite(ExecutionEngine *e, char *data, int index, const Val
     double d = value.toNumber();
     if (e->hasException)
         return;
-    // ### is there a way to optimise this?
-    if (d <= 0 || std::isnan(d)) {
-        data[index] = 0;
-        return;
-    }
-    if (d >= 255) {
-        data[index] = (char)(255);
-        return;
-    }
-    double f = std::floor(d);
-    if (f + 0.5 < d) {
-        data[index] = (unsigned char)(f + 1);
-        return;
-    }
-    if (d < f + 0.5) {
-        data[index] = (unsigned char)(f);
-        return;
-    }
-    if (int(f) % 2) {
-        // odd number
-        data[index] = (unsigned char)(f + 1);
-        return;
-    }
-    data[index] = (unsigned char)(f);
+    data[index] = clampToUInt8(d);
 }
 
 ReturnedValue Int16ArrayRead(const char *data, int index)
@@ -195,6 +192,134 @@ const TypedArrayOperations operations[Heap::TypedArray::NTypes] = {
     { 8, "Float64Array", Float64ArrayRead, Float64ArrayWrite },
 };
 
+namespace {
+
+// Bulk conversions between typed arrays, and from arrays of numbers, without going through
+// the per element read and write functions and a boxed Value for every element. The loops
+// are simple enough for the compiler to vectorize.
+
+struct Clamped {
+    unsigned char value;
+};
+
+inline qint64 loadElement(const signed char *p) { return *p; }
+inline qint64 loadElement(const unsigned char *p) { return *p; }
+inline qint64 loadElement(const Clamped *p) { return p->value; }
+inline qint64 loadElement(const short *p) { return *p; }
+inline qint64 loadElement(const unsigned short *p) { return *p; }
+inline qint64 loadElement(const int *p) { return *p; }
+inline qint64 loadElement(const unsigned int *p) { return *p; }
+inline double loadElement(const float *p) { return *p; }
+inline double loadElement(const double *p) { return *p; }
+
+inline void storeElement(signed char *p, qint64 v) { *p = (signed char)v; }
+inline void storeElement(signed char *p, double v) { *p = (signed char)Primitive::toInt32(v); }
+inline void storeElement(unsigned char *p, qint64 v) { *p = (unsigned char)v; }
+inline void storeElement(unsigned char *p, double v) { *p = (unsigned char)Primitive::toInt32(v); }
+inline void storeElement(Clamped *p, qint64 v) { p->value = (unsigned char)qBound(Q_INT64_C(0), v, Q_INT64_C(255)); }
+inline void storeElement(Clamped *p, double v) { p->value = clampToUInt8(v); }
+inline void storeElement(short *p, qint64 v) { *p = (short)v; }
+inline void storeElement(short *p, double v) { *p = (short)Primitive::toInt32(v); }
+inline void storeElement(unsigned short *p, qint64 v) { *p = (unsigned short)v; }
+inline void storeElement(unsigned short *p, double v) { *p = (unsigned short)Primitive::toInt32(v); }
+inline void storeElement(int *p, qint64 v) { *p = (int)v; }
+inline void storeElement(int *p, double v) { *p = Primitive::toInt32(v); }
+inline void storeElement(unsigned int *p, qint64 v) { *p = (unsigned int)v; }
+inline void storeElement(unsigned int *p, double v) { *p = Primitive::toUInt32(v); }
+inline void storeElement(float *p, qint64 v) { *p = (float)v; }
+inline void storeElement(float *p, double v) { *p = (float)v; }
+inline void storeElement(double *p, qint64 v) { *p = (double)v; }
+inline void storeElement(double *p, double v) { *p = v; }
+
+typedef void (*ElementConverter)(char *dest, const char *src, uint n);
+
+template <typename Src, typename Dst>
+void convertElements(char *dest, const char *src, uint n)
+{
+    const Src *s = reinterpret_cast<const Src *>(src);
+    Dst *d = reinterpret_cast<Dst *>(dest);
+    for (uint i = 0; i < n; ++i)
+        storeElement(d + i, loadElement(s + i));
+}
+
+#define CONVERTERS_FROM(Src) { \
+    convertElements<Src, signed char>, \
+    convertElements<Src, unsigned char>, \
+    convertElements<Src, Clamped>, \
+    convertElements<Src, short>, \
+    convertElements<Src, unsigned short>, \
+    convertElements<Src, int>, \
+    convertElements<Src, unsigned int>, \
+    convertElements<Src, float>, \
+    convertElements<Src, double> \
+}
+
+// indexed by source and destination type
+const ElementConverter converters[Heap::TypedArray::NTypes][Heap::TypedArray::NTypes] = {
+    CONVERTERS_FROM(signed char),
+    CONVERTERS_FROM(unsigned char),
+    CONVERTERS_FROM(Clamped),
+    CONVERTERS_FROM(short),
+    CONVERTERS_FROM(unsigned short),
+    CONVERTERS_FROM(int),
+    CONVERTERS_FROM(unsigned int),
+    CONVERTERS_FROM(float),
+    CONVERTERS_FROM(double)
+};
+
+#undef CONVERTERS_FROM
+
+void convertTypedArrayElements(char *dest, Heap::TypedArray::Type destType, const char *src, Heap::TypedArray::Type srcType, uint n)
+{
+    if (srcType == destType)
+        memmove(dest, src, n * operations[srcType].bytesPerElement);
+    else
+        converters[srcType][destType](dest, src, n);
+}
+
+typedef uint (*NumberStorer)(char *dest, const Heap::SimpleArrayData *s, uint n);
+
+// Stores the leading numbers of the array data, and returns how many it stored. Stops at the
+// first hole or other value that needs the generic conversion.
+template <typename Dst>
+uint storeNumbers(char *dest, const Heap::SimpleArrayData *s, uint n)
+{
+    Dst *d = reinterpret_cast<Dst *>(dest);
+    n = qMin(n, s->len);
+    for (uint i = 0; i < n; ++i) {
+        const Value v = s->data(i);
+        if (v.isInteger())
+            storeElement(d + i, qint64(v.integerValue()));
+        else if (v.isDouble())
+            storeElement(d + i, v.doubleValue());
+        else
+            return i;
+    }
+    return n;
+}
+
+const NumberStorer numberStorers[Heap::TypedArray::NTypes] = {
+    storeNumbers<signed char>,
+    storeNumbers<unsigned char>,
+    storeNumbers<Clamped>,
+    storeNumbers<short>,
+    storeNumbers<unsigned short>,
+    storeNumbers<int>,
+    storeNumbers<unsigned int>,
+    storeNumbers<float>,
+    storeNumbers<double>
+};
+
+uint storeNumbersFromArray(char *dest, Heap::TypedArray::Type destType, const Object *o, uint n)
+{
+    Heap::ArrayData *arrayData = o->d()->arrayData;
+    if (!arrayData || arrayData->type != Heap::ArrayData::Simple || arrayData->attrs)
+        return 0;
+    return numberStorers[destType](dest, static_cast<Heap::SimpleArrayData *>(arrayData), n);
+}
+
+} // anonymous namespace
+
 
 Heap::TypedArrayCtor::TypedArrayCtor(QV4::ExecutionContext *scope, TypedArray::Type t)
     : Heap::FunctionObject(scope, QLatin1String(operations[t].name))
@@ -248,20 +373,7 @@ ReturnedValue TypedArrayCtor::construct(const Managed *m, CallData *callData)
         const char *src = buffer->d()->data->data() + typedArray->d()->byteOffset;
         char *dest = newBuffer->d()->data->data();
 
-        // check if src and new type have the same size. In that case we can simply memcpy the data
-        if (srcElementSize == destElementSize) {
-            memcpy(dest, src, byteLength);
-        } else {
-            // not same size, we need to loop
-            uint l = typedArray->length();
-            TypedArrayRead read = typedArray->d()->type->read;
-            TypedArrayWrite write =array->d()->type->write;
-            for (uint i = 0; i < l; ++i) {
-                Primitive val;
-                val.setRawValue(read(src, i*srcElementSize));
-                write(scope.engine, dest, i*destElementSize, val);
-            }
-        }
+        convertTypedArrayElements(dest, that->d()->type, src, typedArray->arrayType(), typedArray->length());
 
         return array.asReturnedValue();
     }
@@ -314,8 +426,9 @@ ReturnedValue TypedArrayCtor::construct(const Managed *m, CallData *callData)
     array->d()->byteLength = l * elementSize;
     array->d()->byteOffset = 0;
 
-    uint idx = 0;
     char *b = newBuffer->d()->data->data();
+    uint idx = storeNumbersFromArray(b, that->d()->type, o, l);
+    b += idx * elementSize;
     ScopedValue val(scope);
     while (idx < l) {
         val = o->getIndexed(idx);
@@ -483,8 +596,9 @@ ReturnedValue TypedArrayPrototype::method_set(CallContext *ctx)
         if (offset + l > a->length())
             return scope.engine->throwRangeError(QStringLiteral("TypedArray.set: out of range"));
 
-        uint idx = 0;
         char *b = buffer->d()->data->data() + a->d()->byteOffset + offset*elementSize;
+        uint idx = storeNumbersFromArray(b, a->arrayType(), o, l);
+        b += idx * elementSize;
         ScopedValue val(scope);
         while (idx < l) {
             val = o->getIndexed(idx);
@@ -522,15 +636,7 @@ ReturnedValue TypedArrayPrototype::method_set(CallContext *ctx)
         src = srcCopy;
     }
 
-    // typed arrays of different kind, need to manually loop
-    uint srcElementSize = srcTypedArray->d()->type->bytesPerElement;
-    TypedArrayRead read = srcTypedArray->d()->type->read;
-    TypedArrayWrite write = a->d()->type->write;
-    for (uint i = 0; i < l; ++i) {
-        Primitive val;
-        val.setRawValue(read(src, i*srcElementSize));
-        write(scope.engine, dest, i*elementSize, val);
-    }
+    convertTypedArrayElements(dest, a->arrayType(), src, srcTypedArray->arrayType(), l);
 
     if (srcCopy)
         delete [] srcCopy;
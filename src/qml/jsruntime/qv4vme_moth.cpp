@@ -727,6 +727,10 @@ QV4::ReturnedValue VME::run(ExecutionEngine *engine, const uchar *code
         STOREVALUE(instr.result, Runtime::setupArgumentsObject(engine));
     MOTH_END_INSTR(CallBuiltinSetupArgumentsObject)
 
+    MOTH_BEGIN_INSTR(CallBuiltinGetArgument)
+        STOREVALUE(instr.result, Runtime::getArgument(engine, VALUE(instr.index)));
+    MOTH_END_INSTR(CallBuiltinGetArgument)
+
     MOTH_BEGIN_INSTR(CallBuiltinConvertThisToObject)
         Runtime::convertThisToObject(engine);
         CHECK_EXCEPTION;
@@ -99,6 +99,22 @@ static std::size_t maxChunkSizeValue()
     return result;
 }
 
+static std::size_t maxHeapSizeValue()
+{
+    static std::size_t result = 0;
+    static bool initialized = false;
+    if (!initialized) {
+        initialized = true;
+        if (Q_UNLIKELY(qEnvironmentVariableIsSet("QV4_MM_MAX_HEAP_SIZE"))) {
+            bool ok;
+            const std::size_t overrideValue = qgetenv("QV4_MM_MAX_HEAP_SIZE").toUInt(&ok);
+            if (ok)
+                result = overrideValue;
+        }
+    }
+    return result;
+}
+
 using namespace QV4;
 
 struct MemoryManager::Data
@@ -106,9 +122,17 @@ struct MemoryManager::Data
     struct ChunkHeader {
         Heap::Base freeItems;
         ChunkHeader *nextNonFull;
+        ChunkHeader *nextUnswept;
         char *itemStart;
         char *itemEnd;
+        char *bumpPointer; // items from here on have never been handed out
         int itemSize;
+        bool unswept; // still holds the mark bits of the last GC run
+        bool decommitted; // the pages after the header are given back to the OS
+
+        bool hasFreeItems() { return freeItems.nextFree() || bumpPointer <= itemEnd; }
+        char *decommitStart() { return reinterpret_cast<char *>(roundUpToMultipleOf(WTF::pageSize(), reinterpret_cast<size_t>(itemStart))); }
+        char *chunkEnd() { return itemEnd + itemSize; }
     };
 
     bool gcBlocked;
@@ -118,9 +142,13 @@ struct MemoryManager::Data
 
     enum { MaxItemSize = 512 };
     ChunkHeader *nonFullChunks[MaxItemSize/16];
+    ChunkHeader *unsweptChunks[MaxItemSize/16];
     uint nChunks[MaxItemSize/16];
     uint availableItems[MaxItemSize/16];
     uint allocCount[MaxItemSize/16];
+    uint freedCount[MaxItemSize/16]; // items reclaimed by the last sweep
+    uint itemsInUse[MaxItemSize/16]; // items that were in use when the last sweep started
+    quint64 allocationCount[MaxItemSize/16]; // allocations up to the last GC run
     int totalItems;
     int totalAlloc;
     uint maxShift;
@@ -128,6 +156,13 @@ struct MemoryManager::Data
     QVector<PageAllocation> heapChunks;
     std::size_t unmanagedHeapSize; // the amount of bytes of heap that is not managed by the memory manager, but which is held onto by managed items.
     std::size_t unmanagedHeapSizeGCLimit;
+    qint64 lastGCDuration; // in milliseconds
+
+    QElapsedTimer lifetime;
+    quint64 collectionCount;
+    qint64 totalGCTime; // in microseconds
+    enum { RecentCollectionCount = 16 };
+    MemoryManager::Collection recentCollections[RecentCollectionCount]; // used as a ring buffer
 
     struct LargeItem {
         LargeItem *next;
@@ -140,7 +175,11 @@ struct MemoryManager::Data
     };
 
     LargeItem *largeItems;
+    std::size_t largeItemsSize;
     std::size_t totalLargeItemsAllocated;
+    std::size_t maxHeapSize; // 0 if there is no limit
+    std::size_t heapLimitRetrySize; // don't collect for the limit again before the heap reaches this
+    bool heapLimitExceeded;
 
     // statistics:
 #ifdef DETAILED_MM_STATS
@@ -158,13 +197,39 @@ struct MemoryManager::Data
         , maxChunkSize(maxChunkSizeValue())
         , unmanagedHeapSize(0)
         , unmanagedHeapSizeGCLimit(MIN_UNMANAGED_HEAPSIZE_GC_LIMIT)
+        , lastGCDuration(0)
+        , collectionCount(0)
+        , totalGCTime(0)
         , largeItems(0)
+        , largeItemsSize(0)
         , totalLargeItemsAllocated(0)
+        , maxHeapSize(maxHeapSizeValue())
+        , heapLimitRetrySize(0)
+        , heapLimitExceeded(false)
     {
         memset(nonFullChunks, 0, sizeof(nonFullChunks));
+        memset(unsweptChunks, 0, sizeof(unsweptChunks));
         memset(nChunks, 0, sizeof(nChunks));
         memset(availableItems, 0, sizeof(availableItems));
         memset(allocCount, 0, sizeof(allocCount));
+        memset(freedCount, 0, sizeof(freedCount));
+        memset(itemsInUse, 0, sizeof(itemsInUse));
+        memset(allocationCount, 0, sizeof(allocationCount));
+        lifetime.start();
+    }
+
+    // Memory that counts against maxHeapSize: committed chunk pages and large items.
+    std::size_t heapSize()
+    {
+        std::size_t size = largeItemsSize;
+        for (QVector<PageAllocation>::iterator i = heapChunks.begin(), ei = heapChunks.end(); i != ei; ++i) {
+            ChunkHeader *header = reinterpret_cast<ChunkHeader *>(i->base());
+            if (header->decommitted)
+                size += header->decommitStart() - reinterpret_cast<char *>(header);
+            else
+                size += i->size();
+        }
+        return size;
     }
 
     ~Data()
@@ -178,7 +243,7 @@ struct MemoryManager::Data
 
 namespace {
 
-bool sweepChunk(MemoryManager::Data::ChunkHeader *header, uint *itemsInUse, ExecutionEngine *engine, std::size_t *unmanagedHeapSize)
+bool sweepChunk(MemoryManager::Data::ChunkHeader *header, uint *itemsInUse, uint *itemsFreed, ExecutionEngine *engine, std::size_t *unmanagedHeapSize)
 {
     Q_ASSERT(unmanagedHeapSize);
 
@@ -188,7 +253,7 @@ bool sweepChunk(MemoryManager::Data::ChunkHeader *header, uint *itemsInUse, Exec
 #ifdef V4_USE_VALGRIND
     VALGRIND_DISABLE_ERROR_REPORTING;
 #endif
-    for (char *item = header->itemStart; item <= header->itemEnd; item += header->itemSize) {
+    for (char *item = header->itemStart; item < header->bumpPointer; item += header->itemSize) {
         Heap::Base *m = reinterpret_cast<Heap::Base *>(item);
 //        qDebug("chunk @ %p, in use: %s, mark bit: %s",
 //               item, (m->inUse() ? "yes" : "no"), (m->isMarked() ? "true" : "false"));
@@ -223,6 +288,7 @@ bool sweepChunk(MemoryManager::Data::ChunkHeader *header, uint *itemsInUse, Exec
 #endif
                 Q_V4_PROFILE_DEALLOC(engine, m, header->itemSize, Profiling::SmallItem);
                 ++(*itemsInUse);
+                ++(*itemsFreed);
             }
             // Relink all free blocks to rewrite references to any released chunk.
             tail->setNextFree(m);
@@ -236,6 +302,23 @@ bool sweepChunk(MemoryManager::Data::ChunkHeader *header, uint *itemsInUse, Exec
     return isEmpty;
 }
 
+// Sweeps the chunks of one size class that sweep() left behind, until one of them has a free item.
+MemoryManager::Data::ChunkHeader *sweepForAllocation(MemoryManager::Data *d, std::size_t pos)
+{
+    while (MemoryManager::Data::ChunkHeader *header = d->unsweptChunks[pos]) {
+        d->unsweptChunks[pos] = header->nextUnswept;
+        header->nextUnswept = 0;
+        header->unswept = false;
+        sweepChunk(header, &d->itemsInUse[pos], &d->freedCount[pos], d->engine, &d->unmanagedHeapSize);
+        if (header->hasFreeItems()) {
+            header->nextNonFull = d->nonFullChunks[pos];
+            d->nonFullChunks[pos] = header;
+            return header;
+        }
+    }
+    return 0;
+}
+
 } // namespace
 
 MemoryManager::MemoryManager(ExecutionEngine *engine)
@@ -283,6 +366,9 @@ Heap::Base *MemoryManager::allocData(std::size_t size, std::size_t unmanagedSize
         if (!didGCRun && m_d->totalLargeItemsAllocated > 8 * 1024 * 1024)
             runGC();
 
+        if (m_d->maxHeapSize)
+            enforceHeapLimit(size + sizeof(MemoryManager::Data::LargeItem));
+
         // we use malloc for this
         MemoryManager::Data::LargeItem *item = static_cast<MemoryManager::Data::LargeItem *>(
                 malloc(Q_V4_PROFILE_ALLOC(engine, size + sizeof(MemoryManager::Data::LargeItem),
@@ -291,57 +377,67 @@ Heap::Base *MemoryManager::allocData(std::size_t size, std::size_t unmanagedSize
         item->next = m_d->largeItems;
         item->size = size;
         m_d->largeItems = item;
+        m_d->largeItemsSize += size;
         m_d->totalLargeItemsAllocated += size;
         return item->heapObject();
     }
 
     Heap::Base *m = 0;
     Data::ChunkHeader *header = m_d->nonFullChunks[pos];
-    if (header) {
-        m = header->freeItems.nextFree();
+    if (!header)
+        header = sweepForAllocation(m_d.data(), pos);
+    if (header)
         goto found;
-    }
 
     // try to free up space, otherwise allocate
     if (!didGCRun && m_d->allocCount[pos] > (m_d->availableItems[pos] >> 1) && m_d->totalAlloc > (m_d->totalItems >> 1) && !m_d->aggressiveGC) {
         runGC();
+        // The collection may already have swept this size class eagerly.
         header = m_d->nonFullChunks[pos];
-        if (header) {
-            m = header->freeItems.nextFree();
+        if (!header)
+            header = sweepForAllocation(m_d.data(), pos);
+        if (header)
             goto found;
-        }
     }
 
     // no free item available, allocate a new chunk
     {
         // allocate larger chunks at a time to avoid excessive GC, but cap at maximum chunk size (2MB by default)
-        uint shift = ++m_d->nChunks[pos];
+        uint shift = m_d->nChunks[pos] + 1;
         if (shift > m_d->maxShift)
             shift = m_d->maxShift;
         std::size_t allocSize = m_d->maxChunkSize*(size_t(1) << shift);
         allocSize = roundUpToMultipleOf(WTF::pageSize(), allocSize);
+
+        if (m_d->maxHeapSize) {
+            enforceHeapLimit(allocSize);
+            header = m_d->nonFullChunks[pos];
+            if (header)
+                goto found;
+        }
+
+        ++m_d->nChunks[pos];
         PageAllocation allocation = PageAllocation::allocate(
                     Q_V4_PROFILE_ALLOC(engine, allocSize, Profiling::HeapPage),
                     OSAllocator::JSGCHeapPages);
         m_d->heapChunks.append(allocation);
 
         header = reinterpret_cast<Data::ChunkHeader *>(allocation.base());
+        header->nextUnswept = 0;
+        header->unswept = false;
+        header->decommitted = false;
         header->itemSize = int(size);
         header->itemStart = reinterpret_cast<char *>(allocation.base()) + roundUpToMultipleOf(16, sizeof(Data::ChunkHeader));
         header->itemEnd = reinterpret_cast<char *>(allocation.base()) + allocation.size() - header->itemSize;
 
+        // Items are handed out by bumping a pointer through the fresh chunk instead of threading
+        // a free list through it first, so pages are only touched once they are needed.
+        header->freeItems.setNextFree(0);
+        header->bumpPointer = header->itemStart;
+
         header->nextNonFull = m_d->nonFullChunks[pos];
         m_d->nonFullChunks[pos] = header;
 
-        Heap::Base *last = &header->freeItems;
-        for (char *item = header->itemStart; item <= header->itemEnd; item += header->itemSize) {
-            Heap::Base *o = reinterpret_cast<Heap::Base *>(item);
-            last->setNextFree(o);
-            last = o;
-
-        }
-        last->setNextFree(0);
-        m = header->freeItems.nextFree();
         const size_t increase = (header->itemEnd - header->itemStart) / header->itemSize;
         m_d->availableItems[pos] += uint(increase);
         m_d->totalItems += int(increase);
@@ -352,6 +448,21 @@ Heap::Base *MemoryManager::allocData(std::size_t size, std::size_t unmanagedSize
     }
 
   found:
+    if (header->decommitted) {
+        OSAllocator::commit(header->decommitStart(), header->chunkEnd() - header->decommitStart(), true, false);
+        header->decommitted = false;
+    }
+    m = header->freeItems.nextFree();
+    if (m) {
+        header->freeItems.setNextFree(m->nextFree());
+    } else {
+        Q_ASSERT(header->bumpPointer <= header->itemEnd);
+        m = reinterpret_cast<Heap::Base *>(header->bumpPointer);
+        header->bumpPointer += header->itemSize;
+    }
+    if (!header->hasFreeItems())
+        m_d->nonFullChunks[pos] = header->nextNonFull;
+
 #ifdef V4_USE_VALGRIND
     VALGRIND_MEMPOOL_ALLOC(this, m, size);
 #endif
@@ -359,9 +470,6 @@ Heap::Base *MemoryManager::allocData(std::size_t size, std::size_t unmanagedSize
 
     ++m_d->allocCount[pos];
     ++m_d->totalAlloc;
-    header->freeItems.setNextFree(m->nextFree());
-    if (!header->freeItems.nextFree())
-        m_d->nonFullChunks[pos] = header->nextNonFull;
     return m;
 }
 
@@ -471,40 +579,29 @@ void MemoryManager::sweep(bool lastSweep)
         }
     }
 
-    bool *chunkIsEmpty = (bool *)alloca(m_d->heapChunks.size() * sizeof(bool));
-    uint itemsInUse[MemoryManager::Data::MaxItemSize/16];
-    memset(itemsInUse, 0, sizeof(itemsInUse));
+    // Small items are swept lazily: the chunks are queued per size class and allocData() sweeps
+    // them when it runs out of free items. This keeps the pause short and defers touching cold
+    // chunks until their memory is actually needed.
     memset(m_d->nonFullChunks, 0, sizeof(m_d->nonFullChunks));
+    memset(m_d->unsweptChunks, 0, sizeof(m_d->unsweptChunks));
+    memset(m_d->itemsInUse, 0, sizeof(m_d->itemsInUse));
+    memset(m_d->freedCount, 0, sizeof(m_d->freedCount));
 
     for (int i = 0; i < m_d->heapChunks.size(); ++i) {
         Data::ChunkHeader *header = reinterpret_cast<Data::ChunkHeader *>(m_d->heapChunks[i].base());
-        chunkIsEmpty[i] = sweepChunk(header, &itemsInUse[header->itemSize >> 4], engine, &m_d->unmanagedHeapSize);
-    }
-
-    QVector<PageAllocation>::iterator chunkIter = m_d->heapChunks.begin();
-    for (int i = 0; i < m_d->heapChunks.size(); ++i) {
-        Q_ASSERT(chunkIter != m_d->heapChunks.end());
-        Data::ChunkHeader *header = reinterpret_cast<Data::ChunkHeader *>(chunkIter->base());
         const size_t pos = header->itemSize >> 4;
-        const size_t decrease = (header->itemEnd - header->itemStart) / header->itemSize;
+        Q_ASSERT(!header->unswept);
+        header->unswept = true;
+        header->nextUnswept = m_d->unsweptChunks[pos];
+        m_d->unsweptChunks[pos] = header;
+    }
 
-        // Release that chunk if it could have been spared since the last GC run without any difference.
-        if (chunkIsEmpty[i] && m_d->availableItems[pos] - decrease >= itemsInUse[pos]) {
-            Q_V4_PROFILE_DEALLOC(engine, 0, chunkIter->size(), Profiling::HeapPage);
-#ifdef V4_USE_VALGRIND
-            VALGRIND_MEMPOOL_FREE(this, header);
-#endif
-            --m_d->nChunks[pos];
-            m_d->availableItems[pos] -= uint(decrease);
-            m_d->totalItems -= int(decrease);
-            chunkIter->deallocate();
-            chunkIter = m_d->heapChunks.erase(chunkIter);
-            continue;
-        } else if (header->freeItems.nextFree()) {
-            header->nextNonFull = m_d->nonFullChunks[pos];
-            m_d->nonFullChunks[pos] = header;
-        }
-        ++chunkIter;
+    if (lastSweep) {
+        sweepRemainingChunks();
+    } else {
+        // Strings give back their unmanaged text when they are swept, and allocData() bases its
+        // GC heuristic on that right after this run, so don't defer them.
+        sweepRemainingChunks(int(MemoryManager::align(sizeof(Heap::String)) >> 4));
     }
 
     Data::LargeItem *i = m_d->largeItems;
@@ -522,6 +619,7 @@ void MemoryManager::sweep(bool lastSweep)
             m->vtable()->destroy(m);
 
         *last = i->next;
+        m_d->largeItemsSize -= i->size;
         free(Q_V4_PROFILE_DEALLOC(engine, i, i->size + sizeof(Data::LargeItem),
                                   Profiling::LargeItem));
         i = *last;
@@ -537,6 +635,83 @@ void MemoryManager::sweep(bool lastSweep)
     }
 }
 
+void MemoryManager::sweepRemainingChunks(int sizeClass)
+{
+    bool *chunkIsEmpty = (bool *)alloca(m_d->heapChunks.size() * sizeof(bool));
+    memset(chunkIsEmpty, 0, m_d->heapChunks.size() * sizeof(bool));
+
+    for (int i = 0; i < m_d->heapChunks.size(); ++i) {
+        Data::ChunkHeader *header = reinterpret_cast<Data::ChunkHeader *>(m_d->heapChunks[i].base());
+        const size_t pos = header->itemSize >> 4;
+        if (!header->unswept || (sizeClass >= 0 && pos != size_t(sizeClass)))
+            continue;
+        chunkIsEmpty[i] = sweepChunk(header, &m_d->itemsInUse[pos], &m_d->freedCount[pos], engine, &m_d->unmanagedHeapSize);
+    }
+
+    // Empty chunks that are kept get queued behind all others, so that they are only recommitted
+    // once nothing else is left.
+    Data::ChunkHeader *decommittedChunks[MemoryManager::Data::MaxItemSize/16];
+    memset(decommittedChunks, 0, sizeof(decommittedChunks));
+
+    // All chunks of the swept size classes are done now, so itemsInUse is complete for them.
+    // Note that i keeps counting the chunks as they were before releasing any of them.
+    QVector<PageAllocation>::iterator chunkIter = m_d->heapChunks.begin();
+    for (int i = 0; chunkIter != m_d->heapChunks.end(); ++i) {
+        Data::ChunkHeader *header = reinterpret_cast<Data::ChunkHeader *>(chunkIter->base());
+        const size_t pos = header->itemSize >> 4;
+        if (!header->unswept || (sizeClass >= 0 && pos != size_t(sizeClass))) {
+            ++chunkIter;
+            continue;
+        }
+        header->unswept = false;
+        header->nextUnswept = 0;
+        const size_t decrease = (header->itemEnd - header->itemStart) / header->itemSize;
+
+        // Release that chunk if it could have been spared since the last GC run without any difference.
+        if (chunkIsEmpty[i] && m_d->availableItems[pos] - decrease >= m_d->itemsInUse[pos]) {
+            Q_V4_PROFILE_DEALLOC(engine, 0, chunkIter->size(), Profiling::HeapPage);
+#ifdef V4_USE_VALGRIND
+            VALGRIND_MEMPOOL_FREE(this, header);
+#endif
+            --m_d->nChunks[pos];
+            m_d->availableItems[pos] -= uint(decrease);
+            m_d->totalItems -= int(decrease);
+            chunkIter->deallocate();
+            chunkIter = m_d->heapChunks.erase(chunkIter);
+            continue;
+        } else if (chunkIsEmpty[i]) {
+            // Keep the address space, but give the pages back to the OS until the chunk is needed
+            // again. All items are free, so the chunk can start over with its bump pointer.
+            if (!header->decommitted && header->decommitStart() < header->chunkEnd()) {
+                OSAllocator::decommit(header->decommitStart(), header->chunkEnd() - header->decommitStart());
+                header->decommitted = true;
+            }
+            header->freeItems.setNextFree(0);
+            header->bumpPointer = header->itemStart;
+            header->nextNonFull = decommittedChunks[pos];
+            decommittedChunks[pos] = header;
+        } else if (header->hasFreeItems()) {
+            header->nextNonFull = m_d->nonFullChunks[pos];
+            m_d->nonFullChunks[pos] = header;
+        }
+        ++chunkIter;
+    }
+
+    for (int pos = 0; pos < MemoryManager::Data::MaxItemSize/16; ++pos) {
+        if (!decommittedChunks[pos])
+            continue;
+        Data::ChunkHeader **tail = &m_d->nonFullChunks[pos];
+        while (*tail)
+            tail = &(*tail)->nextNonFull;
+        *tail = decommittedChunks[pos];
+    }
+
+    if (sizeClass >= 0)
+        m_d->unsweptChunks[sizeClass] = 0;
+    else
+        memset(m_d->unsweptChunks, 0, sizeof(m_d->unsweptChunks));
+}
+
 bool MemoryManager::isGCBlocked() const
 {
     return m_d->gcBlocked;
@@ -556,8 +731,21 @@ void MemoryManager::runGC()
 
     QScopedValueRollback<bool> gcBlocker(m_d->gcBlocked, true);
 
+    QElapsedTimer gcTimer;
+    gcTimer.start();
+
+    // The mark bits of the previous run have to be gone before marking again.
+    sweepRemainingChunks();
+
+    Collection collection;
+    collection.timestamp = m_d->lifetime.elapsed();
+    collection.heapSizeBefore = m_d->heapSize();
+    collection.largeItemsBefore = m_d->largeItemsSize;
+
     if (!m_d->gcStats) {
+        const qint64 markStart = gcTimer.nsecsElapsed();
         mark();
+        collection.markTime = (gcTimer.nsecsElapsed() - markStart) / 1000;
         sweep();
     } else {
         const size_t totalMem = getAllocatedMem();
@@ -565,11 +753,14 @@ void MemoryManager::runGC()
         QElapsedTimer t;
         t.start();
         mark();
+        collection.markTime = t.nsecsElapsed() / 1000;
         qint64 markTime = t.restart();
         const size_t usedBefore = getUsedMem();
         const size_t largeItemsBefore = getLargeItemsMem();
         int chunksBefore = m_d->heapChunks.size();
         sweep();
+        // Don't leave anything for later, otherwise the numbers below are meaningless.
+        sweepRemainingChunks();
         const size_t usedAfter = getUsedMem();
         const size_t largeItemsAfter = getLargeItemsMem();
         qint64 sweepTime = t.elapsed();
@@ -585,12 +776,105 @@ void MemoryManager::runGC()
         qDebug() << "Large item memory before GC:" << largeItemsBefore;
         qDebug() << "Large item memory after GC:" << largeItemsAfter;
         qDebug() << "Large item memory freed up:" << (largeItemsBefore - largeItemsAfter);
+
+        // Objects allocated since the last run that did not survive this one. If this is close
+        // to the number of allocations, most of the garbage is short-lived.
+        uint allocated = 0;
+        uint freed = 0;
+        for (int i = 0; i < MemoryManager::Data::MaxItemSize/16; ++i) {
+            allocated += m_d->allocCount[i];
+            freed += m_d->freedCount[i];
+            if (m_d->allocCount[i] || m_d->freedCount[i])
+                qDebug() << "  " << (i << 4) << "bytes: allocated" << m_d->allocCount[i] << "freed" << m_d->freedCount[i];
+        }
+        qDebug() << "Small items allocated since last GC:" << allocated;
+        qDebug() << "Small items freed:" << freed;
+        if (allocated)
+            qDebug() << "Short-lived ratio:" << qMin(1.0, double(freed) / allocated);
         qDebug() << "======== End GC ========";
     }
 
+    for (int i = 0; i < MemoryManager::Data::MaxItemSize/16; ++i)
+        m_d->allocationCount[i] += m_d->allocCount[i];
     memset(m_d->allocCount, 0, sizeof(m_d->allocCount));
     m_d->totalAlloc = 0;
     m_d->totalLargeItemsAllocated = 0;
+
+    // Sweeping includes what was left over from the previous run.
+    const qint64 gcTime = gcTimer.nsecsElapsed() / 1000;
+    collection.sweepTime = gcTime - collection.markTime;
+    collection.heapSizeAfter = m_d->heapSize();
+    collection.largeItemsAfter = m_d->largeItemsSize;
+    collection.unmanagedHeapSize = m_d->unmanagedHeapSize;
+    m_d->recentCollections[m_d->collectionCount % Data::RecentCollectionCount] = collection;
+    ++m_d->collectionCount;
+    m_d->totalGCTime += gcTime;
+    m_d->lastGCDuration = gcTime / 1000;
+}
+
+MemoryManager::Statistics MemoryManager::statistics() const
+{
+    Statistics stats;
+    stats.allocatedMem = getAllocatedMem();
+    stats.largeItemsMem = m_d->largeItemsSize;
+    stats.unmanagedHeapSize = m_d->unmanagedHeapSize;
+    stats.unmanagedHeapSizeGCLimit = m_d->unmanagedHeapSizeGCLimit;
+    stats.collectionCount = m_d->collectionCount;
+    stats.totalGCTime = m_d->totalGCTime;
+
+    SizeClass sizeClasses[MemoryManager::Data::MaxItemSize/16];
+    for (int i = 0; i < MemoryManager::Data::MaxItemSize/16; ++i) {
+        SizeClass &sizeClass = sizeClasses[i];
+        sizeClass.itemSize = i << 4;
+        sizeClass.chunks = 0;
+        sizeClass.items = 0;
+        sizeClass.itemsInUse = 0;
+        sizeClass.allocations = m_d->allocationCount[i] + m_d->allocCount[i];
+    }
+    for (QVector<PageAllocation>::const_iterator i = m_d->heapChunks.cbegin(), ei = m_d->heapChunks.cend(); i != ei; ++i) {
+        Data::ChunkHeader *header = reinterpret_cast<Data::ChunkHeader *>(i->base());
+        SizeClass &sizeClass = sizeClasses[header->itemSize >> 4];
+        ++sizeClass.chunks;
+        // itemEnd is the start of the last item. availableItems leaves that one out, which is fine
+        // for the collection heuristics, but not for reporting.
+        sizeClass.items += uint((header->itemEnd - header->itemStart) / header->itemSize) + 1;
+        for (char *item = header->itemStart; item < header->bumpPointer; item += header->itemSize) {
+            if (reinterpret_cast<Heap::Base *>(item)->inUse())
+                ++sizeClass.itemsInUse;
+        }
+    }
+    for (int i = 0; i < MemoryManager::Data::MaxItemSize/16; ++i) {
+        if (sizeClasses[i].chunks || sizeClasses[i].allocations)
+            stats.sizeClasses.append(sizeClasses[i]);
+    }
+
+    const quint64 recent = qMin<quint64>(m_d->collectionCount, Data::RecentCollectionCount);
+    stats.recentCollections.reserve(int(recent));
+    for (quint64 i = m_d->collectionCount - recent; i < m_d->collectionCount; ++i)
+        stats.recentCollections.append(m_d->recentCollections[i % Data::RecentCollectionCount]);
+
+    return stats;
+}
+
+bool MemoryManager::runGCInIdleTime(int msecs)
+{
+    if (m_d->gcBlocked || m_d->aggressiveGC)
+        return false;
+
+    // Only collect when the allocation counters are at least half way to the thresholds at which
+    // allocData() would trigger a collection anyway.
+    const bool smallItemsDue = m_d->totalAlloc > (m_d->totalItems >> 2);
+    const bool largeItemsDue = m_d->totalLargeItemsAllocated > 4 * 1024 * 1024;
+    if (!smallItemsDue && !largeItemsDue)
+        return false;
+
+    // Marking cannot be interrupted, so use the previous run as an estimate of how long this one
+    // will take and leave it to the allocator if it won't fit.
+    if (m_d->lastGCDuration > msecs)
+        return false;
+
+    runGC();
+    return true;
 }
 
 size_t MemoryManager::getUsedMem() const
@@ -598,7 +882,7 @@ size_t MemoryManager::getUsedMem() const
     size_t usedMem = 0;
     for (QVector<PageAllocation>::const_iterator i = m_d->heapChunks.cbegin(), ei = m_d->heapChunks.cend(); i != ei; ++i) {
         Data::ChunkHeader *header = reinterpret_cast<Data::ChunkHeader *>(i->base());
-        for (char *item = header->itemStart; item <= header->itemEnd; item += header->itemSize) {
+        for (char *item = header->itemStart; item < header->bumpPointer; item += header->itemSize) {
             Heap::Base *m = reinterpret_cast<Heap::Base *>(item);
             Q_ASSERT((qintptr) item % 16 == 0);
             if (m->inUse())
@@ -618,10 +902,57 @@ size_t MemoryManager::getAllocatedMem() const
 
 size_t MemoryManager::getLargeItemsMem() const
 {
-    size_t total = 0;
-    for (const Data::LargeItem *i = m_d->largeItems; i != 0; i = i->next)
-        total += i->size;
-    return total;
+    return m_d->largeItemsSize;
+}
+
+void MemoryManager::setMaxHeapSize(size_t size)
+{
+    m_d->maxHeapSize = size;
+}
+
+size_t MemoryManager::maxHeapSize() const
+{
+    return m_d->maxHeapSize;
+}
+
+void MemoryManager::enforceHeapLimit(std::size_t additionalSize)
+{
+    Q_ASSERT(m_d->maxHeapSize);
+    if (m_d->heapLimitExceeded)
+        return;
+    if (m_d->heapSize() + additionalSize <= m_d->maxHeapSize) {
+        m_d->heapLimitRetrySize = 0;
+        return;
+    }
+
+    // Only JavaScript code can deal with the exception. Outside of it (while the engine is being
+    // set up, or when C++ code allocates) the exception would stay pending and show up later at
+    // an unrelated point, so the allocation just goes through. Global code runs in the root
+    // context, but sets globalCode while it does.
+    if (!engine->currentContext || engine->hasException
+            || (engine->currentContext == engine->rootContext() && !engine->globalCode))
+        return;
+
+    const std::size_t heapSize = m_d->heapSize();
+    if (heapSize >= m_d->heapLimitRetrySize) {
+        // Collect, and release everything that can be released right away.
+        runGC();
+        sweepRemainingChunks();
+        if (m_d->heapSize() + additionalSize <= m_d->maxHeapSize) {
+            m_d->heapLimitRetrySize = 0;
+            return;
+        }
+
+        // Collecting didn't help, so don't collect again for every further chunk or large item
+        // until the heap has grown noticeably.
+        m_d->heapLimitRetrySize = qMax(heapSize, m_d->heapSize()) + m_d->maxHeapSize / 8;
+    }
+
+    // The allocation still goes through, as none of the callers can deal with a failure. The
+    // exception is picked up by the runtime like any other one thrown from native code. Creating
+    // the error object allocates as well, so don't recurse.
+    QScopedValueRollback<bool> limitExceeded(m_d->heapLimitExceeded, true);
+    engine->throwRangeError(QStringLiteral("Out of memory: the JavaScript heap limit has been exceeded."));
 }
 
 void MemoryManager::growUnmanagedHeapSizeUsage(size_t delta)
@@ -633,6 +964,7 @@ MemoryManager::~MemoryManager()
 {
     delete m_persistentValues;
 
+    sweepRemainingChunks();
     sweep(/*lastSweep*/true);
 
     delete m_weakValues;
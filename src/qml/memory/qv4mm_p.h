@@ -300,13 +300,52 @@ public:
     bool isGCBlocked() const;
     void setGCBlocked(bool blockGC);
     void runGC();
+    bool runGCInIdleTime(int msecs);
 
     void dumpStats() const;
 
+    struct Collection {
+        qint64 timestamp; // milliseconds since the memory manager was created
+        qint64 markTime; // in microseconds
+        qint64 sweepTime; // in microseconds
+        size_t heapSizeBefore;
+        size_t heapSizeAfter;
+        size_t largeItemsBefore;
+        size_t largeItemsAfter;
+        size_t unmanagedHeapSize;
+    };
+
+    struct SizeClass {
+        int itemSize;
+        uint chunks;
+        uint items;
+        uint itemsInUse; // includes garbage that has not been swept yet
+        quint64 allocations; // since the memory manager was created
+    };
+
+    struct Statistics {
+        size_t allocatedMem;
+        size_t largeItemsMem;
+        size_t unmanagedHeapSize;
+        size_t unmanagedHeapSizeGCLimit;
+        quint64 collectionCount;
+        qint64 totalGCTime; // in microseconds
+        QVector<SizeClass> sizeClasses; // only the ones that were ever used
+        QVector<Collection> recentCollections; // oldest first
+    };
+
+    // Walks all chunks, so this is meant for monitoring, not for anything on a hot path.
+    Statistics statistics() const;
+
     size_t getUsedMem() const;
     size_t getAllocatedMem() const;
     size_t getLargeItemsMem() const;
 
+    // A non-zero size limits the memory held by the heap. If an allocation would exceed it even
+    // after a collection, a RangeError is thrown.
+    void setMaxHeapSize(size_t size);
+    size_t maxHeapSize() const;
+
     void growUnmanagedHeapSizeUsage(size_t delta); // called when a JS object grows itself. Specifically: Heap::String::append
 
 protected:
@@ -322,6 +361,8 @@ private:
     void collectFromJSStack() const;
     void mark();
     void sweep(bool lastSweep = false);
+    void sweepRemainingChunks(int sizeClass = -1);
+    void enforceHeapLimit(std::size_t additionalSize);
 
 public:
     QV4::ExecutionEngine *engine;
@@ -993,6 +993,10 @@ QQmlEngine::~QQmlEngine()
   Once the component cache has been cleared, components must be loaded before
   any new objects can be created.
 
+  The engine also caches which files exist in the directories it imports
+  from.  QML files added to those directories after they were first used are
+  only found once the component cache has been cleared.
+
   \sa trimComponentCache()
  */
 void QQmlEngine::clearComponentCache()
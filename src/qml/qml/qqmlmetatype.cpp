@@ -1925,8 +1925,12 @@ const QQmlPrivate::CachedQmlUnit *QQmlMetaType::findCachedCompilationUnit(const
     QQmlMetaTypeData *data = metaTypeData();
     for (QVector<QQmlPrivate::QmlUnitCacheLookupFunction>::ConstIterator it = data->lookupCachedQmlUnit.constBegin(), end = data->lookupCachedQmlUnit.constEnd();
          it != end; ++it) {
-        if (const QQmlPrivate::CachedQmlUnit *unit = (*it)(uri))
-            return unit;
+        if (const QQmlPrivate::CachedQmlUnit *unit = (*it)(uri)) {
+            if (unit->qmlData && unit->qmlData->verifyHeader())
+                return unit;
+            qWarning() << "Ignoring cached compilation unit for" << uri << "generated by a different version of Qt";
+            return 0;
+        }
     }
     return 0;
 }
@@ -50,6 +50,7 @@
 #include <QtCore/qdebug.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qthread.h>
+#include <QtCore/qsemaphore.h>
 #include <QtQml/qqmlfile.h>
 #include <QtCore/qdiriterator.h>
 #include <QtQml/qqmlcomponent.h>
@@ -61,6 +62,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <dirent.h>
 #endif
 
 #if defined (QT_LINUXBASE)
@@ -1081,6 +1083,26 @@ void QQmlTypeLoader::loadThread(QQmlDataBlob *blob)
     }
 
     if (QQmlFile::isSynchronous(blob->m_url)) {
+        if (blob->type() == QQmlDataBlob::QmlFile) {
+            prefetchDependencies();
+
+            // Prefetched documents are keyed by the requested URL, which local files keep as their
+            // final URL.
+            QmlIR::Document *document = 0;
+            {
+                LockHolder<QQmlTypeLoader> holder(this);
+                document = m_prefetchedDocuments.take(blob->m_finalUrl);
+            }
+            if (document) {
+                blob->m_data.setProgress(0xFF);
+                if (blob->m_data.isAsync())
+                    m_thread->callDownloadProgressChanged(blob, 1.);
+
+                setDocument(static_cast<QQmlTypeData *>(blob), document);
+                return;
+            }
+        }
+
         QQmlFile file(m_engine, blob->m_url);
 
         if (file.isError()) {
@@ -1261,6 +1283,204 @@ void QQmlTypeLoader::setCachedUnit(QQmlDataBlob *blob, const QQmlPrivate::Cached
     blob->tryDone();
 }
 
+void QQmlTypeLoader::setDocument(QQmlTypeData *blob, QmlIR::Document *document)
+{
+    QML_MEMORY_SCOPE_URL(blob->url());
+    QQmlCompilingProfiler prof(profiler(), blob->url());
+
+    blob->m_inCallback = true;
+
+    blob->initializeFromDocument(document);
+
+    if (!blob->isError() && !blob->isWaiting())
+        blob->allDependenciesDone();
+
+    if (blob->status() != QQmlDataBlob::Error)
+        blob->m_data.setStatus(QQmlDataBlob::WaitingForDependencies);
+
+    blob->m_inCallback = false;
+
+    blob->tryDone();
+}
+
+namespace {
+class DocumentParser : public QRunnable
+{
+public:
+    DocumentParser(QQmlEngine *engine, const QUrl &url, const QUrl &fileUrl, QmlIR::Document **result,
+                   QSemaphore *finished)
+        : m_engine(engine), m_url(url), m_fileUrl(fileUrl), m_result(result), m_finished(finished)
+        , m_debugMode(QV8Engine::getV4(engine)->debugger != 0)
+        , m_illegalNames(QV8Engine::get(engine)->illegalNames())
+    {
+    }
+
+    void run()
+    {
+        parse();
+        if (m_finished)
+            m_finished->release();
+    }
+
+private:
+    void parse()
+    {
+        QQmlFile file(m_engine, m_fileUrl);
+        if (file.isError())
+            return;
+
+        QScopedPointer<QmlIR::Document> document(new QmlIR::Document(m_debugMode));
+        QmlIR::IRBuilder builder(m_illegalNames);
+        // On errors the file is loaded again the regular way, which reports them.
+        if (builder.generateFromQml(QString::fromUtf8(file.data(), file.size()), m_url.toString(), document.data()))
+            *m_result = document.take();
+    }
+
+    QQmlEngine *m_engine;
+    QUrl m_url;
+    QUrl m_fileUrl;
+    QmlIR::Document **m_result;
+    QSemaphore *m_finished;
+    bool m_debugMode;
+    QSet<QString> m_illegalNames;
+};
+}
+
+/*!
+Reads and parses the local QML documents at \a urls in parallel on the parser thread pool, and
+returns the documents that were parsed successfully. Types that are already loaded or that come
+from a cached compilation unit are skipped. The caller takes ownership of the returned documents.
+
+Like QQmlDataBlob, the files are read from the URLs returned by the engine's URL interceptor, while
+the documents keep the requested URLs, which they are also keyed by.
+
+The number of parser threads can be set with the QML_PARSER_THREADS environment variable; a value
+of 1 disables parallel parsing.
+
+Must be called in the load thread.
+*/
+QHash<QUrl, QmlIR::Document *> QQmlTypeLoader::parseDocuments(const QList<QUrl> &urls)
+{
+    ASSERT_LOADTHREAD();
+
+    QHash<QUrl, QmlIR::Document *> documents;
+    if (urls.count() < 2 || m_parserThreadPool.maxThreadCount() < 2 || m_thread->isShutdown())
+        return documents;
+
+    // Sources replaced by the debugger are picked up by loadThread().
+    if (!QQmlEnginePrivate::get(m_engine)->debugChangesCache().isEmpty())
+        return documents;
+
+    QQmlAbstractUrlInterceptor *urlInterceptor = m_engine->urlInterceptor();
+    QList<QUrl> pending;
+    QList<QUrl> fileUrls;
+    {
+        LockHolder<QQmlTypeLoader> holder(this);
+        foreach (const QUrl &url, urls) {
+            if (pending.contains(url) || m_typeCache.contains(url) || m_prefetchedDocuments.contains(url))
+                continue;
+            const QUrl fileUrl = urlInterceptor ? urlInterceptor->intercept(url, QQmlAbstractUrlInterceptor::QmlFile)
+                                                : url;
+            if (!QQmlFile::isLocalFile(fileUrl) || QQmlMetaType::findCachedCompilationUnit(fileUrl))
+                continue;
+            pending.append(url);
+            fileUrls.append(fileUrl);
+        }
+    }
+
+    if (pending.count() < 2)
+        return documents;
+
+    QSystraceEvent systrace("qml", "QQmlTypeLoader::parseDocuments");
+
+    QVector<QmlIR::Document *> results(pending.count(), 0);
+    QSemaphore finished;
+    for (int ii = 1; ii < pending.count(); ++ii)
+        m_parserThreadPool.start(new DocumentParser(m_engine, pending.at(ii), fileUrls.at(ii), results.data() + ii,
+                                                    &finished));
+    // The load thread parses the first document itself instead of just waiting.
+    DocumentParser(m_engine, pending.first(), fileUrls.first(), results.data(), 0).run();
+    finished.acquire(pending.count() - 1);
+
+    for (int ii = 0; ii < pending.count(); ++ii) {
+        if (results.at(ii))
+            documents.insert(pending.at(ii), results.at(ii));
+    }
+
+    return documents;
+}
+
+/*!
+Reads the dependency manifest named by the QML_DEPENDENCY_MANIFEST environment variable the first
+time a QML document is loaded, and parses all documents listed in it in parallel. The loader then
+takes the parsed documents instead of reading the files one dependency level at a time.
+
+If the manifest does not exist yet, getType() records the URLs of all local QML documents loaded by
+this engine instead, and they are written to it when the engine is destroyed.
+
+Must be called in the load thread.
+*/
+void QQmlTypeLoader::prefetchDependencies()
+{
+    ASSERT_LOADTHREAD();
+
+    if (m_dependenciesPrefetched)
+        return;
+    m_dependenciesPrefetched = true;
+
+    if (m_dependencyManifest.isEmpty())
+        return;
+
+    QFile manifest(m_dependencyManifest);
+    if (m_recordDependencies || !manifest.open(QFile::ReadOnly | QFile::Text))
+        return;
+
+    QList<QUrl> urls;
+    while (!manifest.atEnd()) {
+        const QByteArray line = manifest.readLine().trimmed();
+        if (!line.isEmpty())
+            urls.append(QUrl(QString::fromUtf8(line)));
+    }
+
+    QHash<QUrl, QmlIR::Document *> documents = parseDocuments(urls);
+
+    LockHolder<QQmlTypeLoader> holder(this);
+    m_prefetchedDocuments.unite(documents);
+}
+
+/*!
+Records \a url for the dependency manifest if it is being written.  Called with the type loader
+locked whenever a QQmlTypeData is created, whether its document is read by the loader or was
+parsed in advance.
+*/
+void QQmlTypeLoader::recordDependency(const QUrl &url)
+{
+    if (m_recordDependencies && QQmlFile::isLocalFile(url))
+        m_recordedDependencies.append(url);
+}
+
+void QQmlTypeLoader::writeDependencyManifest()
+{
+    if (!m_recordDependencies || m_recordedDependencies.isEmpty())
+        return;
+
+    QFile manifest(m_dependencyManifest);
+    if (!manifest.open(QFile::WriteOnly | QFile::Text)) {
+        qWarning().nospace() << "QQmlTypeLoader: Cannot write dependency manifest " << m_dependencyManifest
+                             << ": " << manifest.errorString();
+        return;
+    }
+
+    QSet<QUrl> written;
+    foreach (const QUrl &url, m_recordedDependencies) {
+        if (written.contains(url))
+            continue;
+        written.insert(url);
+        manifest.write(url.toString().toUtf8());
+        manifest.write("\n");
+    }
+}
+
 void QQmlTypeLoader::shutdownThread()
 {
     if (m_thread && !m_thread->isShutdown())
@@ -1605,8 +1825,15 @@ QQmlTypeLoader::QQmlTypeLoader(QQmlEngine *engine)
 #ifndef QT_NO_QML_DEBUGGER
       m_profiler(0),
 #endif
-      m_typeCacheTrimThreshold(TYPELOADER_MINIMUM_TRIM_THRESHOLD)
+      m_typeCacheTrimThreshold(TYPELOADER_MINIMUM_TRIM_THRESHOLD),
+      m_dependencyManifest(QFile::decodeName(qgetenv("QML_DEPENDENCY_MANIFEST"))),
+      m_dependenciesPrefetched(false),
+      m_recordDependencies(!m_dependencyManifest.isEmpty() && !QFile::exists(m_dependencyManifest))
 {
+    bool ok;
+    const int parserThreads = qEnvironmentVariableIntValue("QML_PARSER_THREADS", &ok);
+    if (ok)
+        m_parserThreadPool.setMaxThreadCount(parserThreads);
 }
 
 /*!
@@ -1618,6 +1845,7 @@ QQmlTypeLoader::~QQmlTypeLoader()
     // Stop the loader thread before releasing resources
     shutdownThread();
 
+    writeDependencyManifest();
     clearCache();
 
     invalidate();
@@ -1653,6 +1881,7 @@ QQmlTypeData *QQmlTypeLoader::getType(const QUrl &url, Mode mode)
         typeData = new QQmlTypeData(url, this);
         // TODO: if (compiledData == 0), is it safe to omit this insertion?
         m_typeCache.insert(url, typeData);
+        recordDependency(url);
         if (const QQmlPrivate::CachedQmlUnit *cachedUnit = QQmlMetaType::findCachedCompilationUnit(typeData->url())) {
             QQmlTypeLoader::loadWithCachedUnit(typeData, cachedUnit, mode);
         } else {
@@ -1679,6 +1908,46 @@ QQmlTypeData *QQmlTypeLoader::getType(const QUrl &url, Mode mode)
     return typeData;
 }
 
+/*!
+Returns a QQmlTypeData for the specified \a url, initialized from the already parsed \a document
+instead of loading the file again.  The type loader takes ownership of \a document.
+
+Must be called in the load thread.
+*/
+QQmlTypeData *QQmlTypeLoader::getType(const QUrl &url, QmlIR::Document *document)
+{
+    ASSERT_LOADTHREAD();
+
+    if (!document)
+        return getType(url);
+
+    LockHolder<QQmlTypeLoader> holder(this);
+
+    QQmlTypeData *typeData = m_typeCache.value(url);
+
+    if (!typeData) {
+        if (m_typeCache.size() >= m_typeCacheTrimThreshold)
+            trimCache();
+
+        typeData = new QQmlTypeData(url, this);
+        m_typeCache.insert(url, typeData);
+        recordDependency(url);
+        typeData->startLoading();
+        typeData->m_data.setProgress(0xFF);
+
+        unlock();
+        setDocument(typeData, document);
+        lock();
+    } else {
+        // The type was loaded in the meantime as a dependency of another type.
+        delete document;
+    }
+
+    typeData->addref();
+
+    return typeData;
+}
+
 /*!
 Returns a QQmlTypeData for the given \a data with the provided base \a url.  The
 QQmlTypeData will not be cached.
@@ -1792,25 +2061,18 @@ QString QQmlTypeLoader::absoluteFilePath(const QString &path)
     int lastSlash = path.lastIndexOf(QLatin1Char('/'));
     QStringRef dirPath(&path, 0, lastSlash);
 
-    StringSet **fileSet = m_importDirCache.value(QHashedStringRef(dirPath.constData(), dirPath.length()));
-    if (!fileSet) {
-        QHashedString dirPathString(dirPath.toString());
-        bool exists = QDir(dirPathString).exists();
-        QStringHash<bool> *files = exists ? new QStringHash<bool> : 0;
-        m_importDirCache.insert(dirPathString, files);
-        fileSet = m_importDirCache.value(dirPathString);
-    }
+    DirectoryListing **fileSet = directoryListing(dirPath);
     if (!(*fileSet))
         return QString();
 
     QString absoluteFilePath;
     QHashedStringRef fileName(path.constData()+lastSlash+1, path.length()-lastSlash-1);
 
-    bool *value = (*fileSet)->value(fileName);
+    bool *value = (*fileSet)->files.value(fileName);
     if (value) {
         if (*value)
             absoluteFilePath = path;
-    } else {
+    } else if (!(*fileSet)->complete) {
         bool exists = false;
 #ifdef Q_OS_UNIX
         struct stat statBuf;
@@ -1820,7 +2082,7 @@ QString QQmlTypeLoader::absoluteFilePath(const QString &path)
 #else
         exists = QFile::exists(path);
 #endif
-        (*fileSet)->insert(fileName.toString(), exists);
+        (*fileSet)->files.insert(fileName.toString(), exists);
         if (exists)
             absoluteFilePath = path;
     }
@@ -1857,18 +2119,56 @@ bool QQmlTypeLoader::directoryExists(const QString &path)
         --length;
     QStringRef dirPath(&path, 0, length);
 
-    StringSet **fileSet = m_importDirCache.value(QHashedStringRef(dirPath.constData(), dirPath.length()));
-    if (!fileSet) {
-        QHashedString dirPathString(dirPath.toString());
-        bool exists = QDir(dirPathString).exists();
-        QStringHash<bool> *files = exists ? new QStringHash<bool> : 0;
-        m_importDirCache.insert(dirPathString, files);
-        fileSet = m_importDirCache.value(dirPathString);
-    }
+    DirectoryListing **fileSet = directoryListing(dirPath);
 
     return (*fileSet);
 }
 
+/*!
+Returns the cache entry for the directory at \a path, which is null if the directory does not
+exist.  Where the platform provides the entry types, the directory is read once with readdir() and
+the listing is marked complete, so that probing for files that are not there is a hash lookup
+instead of a stat() call per probe.  Symbolic links are resolved while listing.  If the file system
+doesn't report the type of an entry, the listing stays incomplete and names it doesn't hold are
+checked with stat() when they are first probed.
+
+Files created after a directory was listed are not found until clearDirectoryCache() is called.
+*/
+QQmlTypeLoader::DirectoryListing **QQmlTypeLoader::directoryListing(const QStringRef &path)
+{
+    DirectoryListing **listing = m_importDirCache.value(QHashedStringRef(path.constData(), path.length()));
+    if (listing)
+        return listing;
+
+    QHashedString dirPathString(path.toString());
+    DirectoryListing *files = 0;
+    if (QDir(dirPathString).exists()) {
+        files = new DirectoryListing;
+#if defined(Q_OS_UNIX) && defined(_DIRENT_HAVE_D_TYPE)
+        const QByteArray encodedPath = QFile::encodeName(dirPathString);
+        if (DIR *dir = ::opendir(encodedPath.constData())) {
+            bool complete = true;
+            while (struct dirent *entry = ::readdir(dir)) {
+                bool isFile = entry->d_type == DT_REG;
+                if (entry->d_type == DT_LNK) {
+                    struct stat statBuf;
+                    const QByteArray entryPath = encodedPath + '/' + entry->d_name;
+                    isFile = ::stat(entryPath.constData(), &statBuf) == 0 && S_ISREG(statBuf.st_mode);
+                } else if (entry->d_type == DT_UNKNOWN) {
+                    complete = false;
+                }
+                if (isFile)
+                    files->files.insert(QFile::decodeName(entry->d_name), true);
+            }
+            ::closedir(dir);
+            files->complete = complete;
+        }
+#endif
+    }
+    m_importDirCache.insert(dirPathString, files);
+    return m_importDirCache.value(dirPathString);
+}
+
 
 /*!
 Return a QmldirContent for absoluteFilePath.  The QmldirContent may be cached.
@@ -1950,15 +2250,27 @@ void QQmlTypeLoader::clearCache()
         (*iter)->release();
     for (QmldirCache::Iterator iter = m_qmldirCache.begin(), end = m_qmldirCache.end(); iter != end; ++iter)
         (*iter)->release();
-    qDeleteAll(m_importDirCache);
+    clearDirectoryCache();
     qDeleteAll(m_importQmlDirCache);
+    qDeleteAll(m_prefetchedDocuments);
 
     m_typeCache.clear();
     m_typeCacheTrimThreshold = TYPELOADER_MINIMUM_TRIM_THRESHOLD;
     m_scriptCache.clear();
     m_qmldirCache.clear();
-    m_importDirCache.clear();
     m_importQmlDirCache.clear();
+    m_prefetchedDocuments.clear();
+}
+
+/*!
+Forgets the cached directory listings and file lookups used to resolve imports, so that files
+created or removed since are seen by the next import resolution.  Loaded types are kept.  This
+is also done by clearCache().
+*/
+void QQmlTypeLoader::clearDirectoryCache()
+{
+    qDeleteAll(m_importDirCache);
+    m_importDirCache.clear();
 }
 
 void QQmlTypeLoader::updateTypeCacheTrimThreshold()
@@ -2205,6 +2517,12 @@ void QQmlTypeData::dataReceived(const Data &data)
     continueLoadFromIR();
 }
 
+void QQmlTypeData::initializeFromDocument(QmlIR::Document *document)
+{
+    m_document.reset(document);
+    continueLoadFromIR();
+}
+
 void QQmlTypeData::initializeFromCachedUnit(const QQmlPrivate::CachedQmlUnit *unit)
 {
     QQmlEngine *qmlEngine = typeLoader()->engine();
@@ -2372,6 +2690,9 @@ void QQmlTypeData::resolveTypes()
         }
     }
 
+    QList<int> compositeTypes;
+    QList<QUrl> compositeTypeUrls;
+
     for (QV4::CompiledData::TypeReferenceMap::ConstIterator unresolvedRef = m_document->typeReferences.constBegin(), end = m_document->typeReferences.constEnd();
          unresolvedRef != end; ++unresolvedRef) {
 
@@ -2427,8 +2748,8 @@ void QQmlTypeData::resolveTypes()
         }
 
         if (ref.type && ref.type->isComposite()) {
-            ref.typeData = typeLoader()->getType(ref.type->sourceUrl());
-            addDependency(ref.typeData);
+            compositeTypes << unresolvedRef.key();
+            compositeTypeUrls << ref.type->sourceUrl();
         }
         ref.majorVersion = majorVersion;
         ref.minorVersion = minorVersion;
@@ -2440,6 +2761,15 @@ void QQmlTypeData::resolveTypes()
 
         m_resolvedTypes.insert(unresolvedRef.key(), ref);
     }
+
+    // Parse the documents of the referenced types up front, so that independent files are parsed
+    // in parallel. Loading them and resolving their own dependencies stays sequential.
+    QHash<QUrl, QmlIR::Document *> documents = typeLoader()->parseDocuments(compositeTypeUrls);
+    for (int ii = 0; ii < compositeTypes.count(); ++ii) {
+        TypeReference &ref = m_resolvedTypes[compositeTypes.at(ii)];
+        ref.typeData = typeLoader()->getType(compositeTypeUrls.at(ii), documents.take(compositeTypeUrls.at(ii)));
+        addDependency(ref.typeData);
+    }
 }
 
 bool QQmlTypeData::resolveType(const QString &typeName, int &majorVersion, int &minorVersion, TypeReference &ref)
@@ -47,6 +47,7 @@
 
 #include <QtCore/qobject.h>
 #include <QtCore/qatomic.h>
+#include <QtCore/qthreadpool.h>
 #include <QtNetwork/qnetworkreply.h>
 #include <QtQml/qqmlerror.h>
 #include <QtQml/qqmlengine.h>
@@ -296,6 +297,7 @@ public:
     void setQmldirContent(const QString &filePath, const QString &content);
 
     void clearCache();
+    void clearDirectoryCache();
     void trimCache();
 
     bool isTypeLoaded(const QUrl &url) const;
@@ -323,11 +325,18 @@ public:
 
 private:
     friend class QQmlDataBlob;
+    friend class QQmlTypeData;
     friend class QQmlTypeLoaderThread;
     friend class QQmlTypeLoaderNetworkReplyProxy;
 
     void shutdownThread();
 
+    QHash<QUrl, QmlIR::Document *> parseDocuments(const QList<QUrl> &urls);
+    void prefetchDependencies();
+    void recordDependency(const QUrl &url);
+    void writeDependencyManifest();
+    QQmlTypeData *getType(const QUrl &url, QmlIR::Document *document);
+
     void loadThread(QQmlDataBlob *);
     void loadWithStaticDataThread(QQmlDataBlob *, const QByteArray &);
     void loadWithCachedUnitThread(QQmlDataBlob *blob, const QQmlPrivate::CachedQmlUnit *unit);
@@ -340,6 +349,7 @@ private:
     void setData(QQmlDataBlob *, QQmlFile *);
     void setData(QQmlDataBlob *, const QQmlDataBlob::Data &);
     void setCachedUnit(QQmlDataBlob *blob, const QQmlPrivate::CachedQmlUnit *unit);
+    void setDocument(QQmlTypeData *blob, QmlIR::Document *document);
 
     template<typename T>
     struct TypedCallback
@@ -360,8 +370,15 @@ private:
     typedef QHash<QUrl, QQmlTypeData *> TypeCache;
     typedef QHash<QUrl, QQmlScriptBlob *> ScriptCache;
     typedef QHash<QUrl, QQmlQmldirData *> QmldirCache;
-    typedef QStringHash<bool> StringSet;
-    typedef QStringHash<StringSet*> ImportDirCache;
+    struct DirectoryListing
+    {
+        DirectoryListing() : complete(false) {}
+
+        QStringHash<bool> files;
+        // Set if files holds every regular file of the directory, so that other names don't exist.
+        bool complete;
+    };
+    typedef QStringHash<DirectoryListing *> ImportDirCache;
     typedef QStringHash<QmldirContent *> ImportQmlDirCache;
 
     QQmlEngine *m_engine;
@@ -378,10 +395,17 @@ private:
     QmldirCache m_qmldirCache;
     ImportDirCache m_importDirCache;
     ImportQmlDirCache m_importQmlDirCache;
+    QThreadPool m_parserThreadPool;
+    QHash<QUrl, QmlIR::Document *> m_prefetchedDocuments;
+    QList<QUrl> m_recordedDependencies;
+    QString m_dependencyManifest;
+    bool m_dependenciesPrefetched : 1;
+    bool m_recordDependencies : 1;
 
     template<typename Loader>
     void doLoad(const Loader &loader, QQmlDataBlob *blob, Mode mode);
     void updateTypeCacheTrimThreshold();
+    DirectoryListing **directoryListing(const QStringRef &path);
 
     friend struct PlainLoader;
     friend struct CachedLoader;
@@ -449,6 +473,7 @@ protected:
     virtual QString stringAt(int index) const;
 
 private:
+    void initializeFromDocument(QmlIR::Document *document);
     void continueLoadFromIR();
     void resolveTypes();
     void compile();
@@ -59,6 +59,7 @@
 #include <QtGui/qstylehints.h>
 #include <QtCore/qvarlengtharray.h>
 #include <QtCore/qabstractanimation.h>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QLibraryInfo>
 #include <QtCore/QRunnable>
 #include <QtQml/qqmlincubator.h>
@@ -66,6 +67,8 @@
 #include <QtQuick/private/qquickpixmapcache_p.h>
 
 #include <private/qqmlmemoryprofiler_p.h>
+#include <private/qqmlengine_p.h>
+#include <private/qv4mm_p.h>
 
 #include <private/qopenglvertexarrayobject_p.h>
 
@@ -130,6 +133,8 @@ protected:
 
 public slots:
     void incubate() {
+        QElapsedTimer timer;
+        timer.start();
         if (incubatingObjectCount()) {
             if (m_renderLoop->interleaveIncubation()) {
                 incubateFor(m_incubation_time);
@@ -139,6 +144,12 @@ public slots:
                     incubateAgain();
             }
         }
+
+        // Spend what is left of the slice on a garbage collection that would otherwise be
+        // triggered by an allocation in the middle of one of the next frames.
+        const int remaining = m_incubation_time - int(timer.elapsed());
+        if (remaining > 0 && engine())
+            QQmlEnginePrivate::getV4Engine(engine())->memoryManager->runGCInIdleTime(remaining);
     }
 
     void animationStopped() { incubate(); }
@@ -44,6 +44,8 @@
 #include <qqmlcomponent.h>
 #include <stdlib.h>
 #include <private/qv4alloca_p.h>
+#include <private/qv8engine_p.h>
+#include <private/qv4mm_p.h>
 
 #ifdef Q_CC_MSVC
 #define NO_INLINE __declspec(noinline)
@@ -201,6 +203,18 @@ private slots:
 
     void malformedExpression();
 
+    void heapLimit();
+    void gcStatistics();
+    void stringGarbageReusesHeap();
+    void polymorphicPropertyAccess();
+    void changeMembersOfLargeObject();
+    void appendToArrayThroughIndex();
+    void typedArrayConversions();
+    void appendToStringInLoop();
+    void compareValuesOfUnknownType();
+    void inlineSmallFunctions();
+    void readArgumentsDirectly();
+
 signals:
     void testSignal();
 };
@@ -3895,6 +3909,342 @@ void tst_QJSEngine::malformedExpression()
     engine.evaluate("5%55555&&5555555\n7-0");
 }
 
+void tst_QJSEngine::heapLimit()
+{
+    QJSEngine engine;
+    QV4::MemoryManager *mm = QV8Engine::getV4(&engine)->memoryManager;
+    mm->setMaxHeapSize(mm->getAllocatedMem() + mm->getLargeItemsMem() + 4 * 1024 * 1024);
+
+    QJSValue caught = engine.evaluate(
+                "function fill() { var a = []; for (var i = 0; i < 1000000; ++i) a.push({ value: i }); }\n"
+                "var caught = false;\n"
+                "try { fill(); } catch (e) { caught = e instanceof RangeError; }\n"
+                "caught");
+    QVERIFY(caught.isBool());
+    QVERIFY(caught.toBool());
+
+    // Once the garbage is gone, the engine is usable again.
+    mm->runGC();
+    QCOMPARE(engine.evaluate("[1, 2, 3].length").toInt(), 3);
+
+    // Outside of JavaScript the limit is not enforced, as nothing would pick up the exception.
+    QV4::ExecutionEngine *v4 = QV8Engine::getV4(&engine);
+    mm->setMaxHeapSize(1);
+    for (int i = 0; i < 100000; ++i)
+        engine.newObject();
+    QVERIFY(!v4->hasException);
+    mm->runGC();
+
+    // Running out repeatedly keeps throwing, without pending exceptions in between.
+    mm->setMaxHeapSize(mm->getAllocatedMem() + mm->getLargeItemsMem() + 4 * 1024 * 1024);
+    caught = engine.evaluate(
+                "var count = 0;\n"
+                "for (var j = 0; j < 3; ++j) { try { fill(); } catch (e) { if (e instanceof RangeError) ++count; } }\n"
+                "count");
+    QCOMPARE(caught.toInt(), 3);
+    QVERIFY(!v4->hasException);
+
+    // Global code is limited as well, and the exception ends the evaluation.
+    mm->runGC();
+    mm->setMaxHeapSize(mm->getAllocatedMem() + mm->getLargeItemsMem() + 4 * 1024 * 1024);
+    caught = engine.evaluate(
+                "var topLevel = [];\n"
+                "for (var k = 0; k < 1000000; ++k) topLevel.push({ value: k });\n"
+                "k");
+    QVERIFY(caught.isError());
+    QCOMPARE(caught.property("name").toString(), QStringLiteral("RangeError"));
+    QVERIFY(!v4->hasException);
+    engine.evaluate("topLevel = null");
+    mm->runGC();
+    QCOMPARE(engine.evaluate("[1, 2, 3].length").toInt(), 3);
+    mm->setMaxHeapSize(0);
+}
+
+void tst_QJSEngine::gcStatistics()
+{
+    QJSEngine engine;
+    QV4::MemoryManager *mm = QV8Engine::getV4(&engine)->memoryManager;
+
+    engine.evaluate("var keep = []; for (var i = 0; i < 1000; ++i) { keep.push({ value: i }); ({ garbage: i }); }");
+    const quint64 collectionsBefore = mm->statistics().collectionCount;
+    engine.collectGarbage();
+    engine.collectGarbage();
+
+    QV4::MemoryManager::Statistics stats = mm->statistics();
+    QCOMPARE(stats.collectionCount, collectionsBefore + 2);
+    QVERIFY(!stats.recentCollections.isEmpty());
+    QVERIFY(stats.recentCollections.size() <= 16);
+    QVERIFY(stats.recentCollections.last().timestamp >= stats.recentCollections.first().timestamp);
+    QVERIFY(stats.allocatedMem > 0);
+    QVERIFY(stats.totalGCTime >= 0);
+
+    quint64 allocations = 0;
+    uint itemsInUse = 0;
+    foreach (const QV4::MemoryManager::SizeClass &sizeClass, stats.sizeClasses) {
+        QVERIFY(sizeClass.itemsInUse <= sizeClass.items);
+        allocations += sizeClass.allocations;
+        itemsInUse += sizeClass.itemsInUse;
+    }
+    QVERIFY(allocations >= 2000);
+    QVERIFY(itemsInUse >= 1000);
+}
+
+void tst_QJSEngine::stringGarbageReusesHeap()
+{
+    QJSEngine engine;
+    QV4::MemoryManager *mm = QV8Engine::getV4(&engine)->memoryManager;
+
+    // Collections triggered by string allocations must let the strings reuse the swept chunks
+    // instead of allocating new ones.
+    engine.evaluate("function churn() { var s; for (var i = 0; i < 200000; ++i) s = 'x' + i; return s; }");
+    engine.evaluate("churn()");
+    const size_t allocatedMem = mm->getAllocatedMem();
+    for (int i = 0; i < 4; ++i)
+        engine.evaluate("churn()");
+    QVERIFY(mm->getAllocatedMem() <= 2 * allocatedMem);
+}
+
+void tst_QJSEngine::polymorphicPropertyAccess()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+        "function make(i) { var o = {}; for (var k = 0; k < i % 12; ++k) o['p' + k] = k; o.x = i; return o; }\n"
+        "function getX(o) { return o.x; }\n"
+        "function setX(o, v) { o.x = v; }\n"
+        "function setLength(o, v) { o.length = v; }\n"
+        "var objects = [];\n"
+        "for (var i = 0; i < 48; ++i) objects.push(make(i));\n"
+        "var proto = { x: -1 };\n"
+        "for (var i = 0; i < 4; ++i) { var o = Object.create(proto); o['q' + i] = i; objects.push(o); }\n"
+        "var sum = 0;\n"
+        "for (var round = 0; round < 3; ++round)\n"
+        "    for (var i = 0; i < objects.length; ++i) sum += getX(objects[i]);\n"
+        "for (var i = 0; i < 48; ++i) setX(objects[i], 2 * i);\n"
+        "var frozen = Object.freeze({ x: 5 });\n"
+        "setX(frozen, 6);\n"
+        "for (var i = 0; i < 48; ++i) setLength(objects[i], i);\n"
+        "var array = [1, 2, 3, 4];\n"
+        "setLength(array, 2);\n"
+        "var plain = {};\n"
+        "Object.defineProperty(plain, 'length', { value: 0, writable: true });\n"
+        "setLength(plain, 1);\n"
+        "plain.length = 1;\n"
+        "function truncate(a) { a.length = 0; }\n"
+        "var other = [1, 2, 3];\n"
+        "truncate(other);\n"
+        "var another = [5, 6];\n"
+        "setLength(another, 0);\n"
+        "[sum, getX(objects[47]), getX(objects[50]), frozen.x, objects[10].length, array.length, array[2],\n"
+        " plain.length, other.length, other[0], another.length, another[0]]");
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toInt(), 3 * (47 * 48 / 2 - 4));
+    QCOMPARE(result.property(1).toInt(), 94);
+    QCOMPARE(result.property(2).toInt(), -1);
+    QCOMPARE(result.property(3).toInt(), 5);
+    QCOMPARE(result.property(4).toInt(), 10);
+    QCOMPARE(result.property(5).toInt(), 2);
+    QVERIFY(result.property(6).isUndefined());
+    QCOMPARE(result.property(7).toInt(), 1);
+    QCOMPARE(result.property(8).toInt(), 0);
+    QVERIFY(result.property(9).isUndefined());
+    QCOMPARE(result.property(10).toInt(), 0);
+    QVERIFY(result.property(11).isUndefined());
+}
+
+void tst_QJSEngine::changeMembersOfLargeObject()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+        "var map = {};\n"
+        "for (var i = 0; i < 200; ++i) map['key' + i] = i;\n"
+        "for (var i = 0; i < 200; i += 2) delete map['key' + i];\n"
+        "Object.defineProperty(map, 'key1', { get: function() { return 'getter'; }, configurable: true });\n"
+        "Object.defineProperty(map, 'key3', { value: 3, writable: false });\n"
+        "map.key3 = 4;\n"
+        "delete map.key1;\n"
+        "Object.preventExtensions(map);\n"
+        "delete map.key5;\n"
+        "map.added = true;\n"
+        "var sum = 0;\n"
+        "for (var k in map) sum += map[k];\n"
+        "[Object.keys(map).length, sum, map.key3, map.key199, 'added' in map, 'key1' in map]");
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toInt(), 98);
+    // the odd numbers below 200, without 1 and 5
+    QCOMPARE(result.property(1).toInt(), 100 * 100 - 6);
+    QCOMPARE(result.property(2).toInt(), 3);
+    QCOMPARE(result.property(3).toInt(), 199);
+    QCOMPARE(result.property(4).toBool(), false);
+    QCOMPARE(result.property(5).toBool(), false);
+}
+
+void tst_QJSEngine::appendToArrayThroughIndex()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+        "function append(a, v) { a[a.length] = v; }\n"
+        "function set(a, i, v) { a[i] = v; }\n"
+        "var points = [];\n"
+        "for (var i = 0; i < 1000; ++i) append(points, i * 0.5);\n"
+        "var presized = new Array(10);\n"
+        "for (var i = 0; i < 5; ++i) set(presized, i, i);\n"
+        "var frozen = Object.freeze([1, 2]);\n"
+        "append(frozen, 3);\n"
+        "var withSetter = [];\n"
+        "var proto = [];\n"
+        "var seen = -1;\n"
+        "Object.defineProperty(proto, 0, { set: function(v) { seen = v; } });\n"
+        "withSetter.__proto__ = proto;\n"
+        "set(withSetter, 0, 42);\n"
+        "[points.length, points[999], presized.length, presized[4], frozen.length, seen, withSetter.length]");
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toInt(), 1000);
+    QCOMPARE(result.property(1).toNumber(), 499.5);
+    QCOMPARE(result.property(2).toInt(), 10);
+    QCOMPARE(result.property(3).toInt(), 4);
+    QCOMPARE(result.property(4).toInt(), 2);
+    QCOMPARE(result.property(5).toInt(), 42);
+    QCOMPARE(result.property(6).toInt(), 0);
+}
+
+void tst_QJSEngine::typedArrayConversions()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+        "var ints = new Int32Array([1, -2, 300, 70000]);\n"
+        "var floats = new Float32Array(ints);\n"
+        "var bytes = new Int8Array(ints);\n"
+        "var clamped = new Uint8ClampedArray([-5, 1.5, 2.5, 254.6, 1000, NaN]);\n"
+        "var fromMixed = new Uint16Array([1, 2.9, '3', { valueOf: function() { return 4; } }, 65537]);\n"
+        "var target = new Float64Array(4);\n"
+        "target.set(new Uint32Array([4294967295, 1]), 1);\n"
+        "var join = Array.prototype.join;\n"
+        "[floats[1], floats[3], bytes[1], bytes[2], join.call(clamped), join.call(fromMixed), join.call(target)]");
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toNumber(), -2.);
+    QCOMPARE(result.property(1).toNumber(), 70000.);
+    QCOMPARE(result.property(2).toInt(), -2);
+    QCOMPARE(result.property(3).toInt(), 44);
+    QCOMPARE(result.property(4).toString(), QStringLiteral("0,2,2,255,255,0"));
+    QCOMPARE(result.property(5).toString(), QStringLiteral("1,2,3,4,1"));
+    QCOMPARE(result.property(6).toString(), QStringLiteral("0,4294967295,1,0"));
+}
+
+void tst_QJSEngine::appendToStringInLoop()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+        "var log = 'start';\n"
+        "for (var i = 0; i < 20000; ++i)\n"
+        "    log += (i % 10) + ';';\n"
+        "var prefixed = 'x';\n"
+        "for (var j = 0; j < 1000; ++j)\n"
+        "    prefixed = 'ab' + prefixed + 'c';\n"
+        "[log.length, log.substr(0, 9), log.substr(log.length - 4), log.charAt(20005), prefixed.length]");
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toInt(), 5 + 20000 * 2);
+    QCOMPARE(result.property(1).toString(), QStringLiteral("start0;1;"));
+    QCOMPARE(result.property(2).toString(), QStringLiteral("8;9;"));
+    QCOMPARE(result.property(3).toString(), QStringLiteral("0"));
+    QCOMPARE(result.property(4).toInt(), 1 + 1000 * 3);
+}
+
+void tst_QJSEngine::compareValuesOfUnknownType()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+        "function count(values, limit) {\n"
+        "    var below = 0, above = 0;\n"
+        "    for (var i = 0; i < values.length; ++i) {\n"
+        "        if (values[i].v < limit.v)\n"
+        "            ++below;\n"
+        "        if (values[i].v >= limit.v)\n"
+        "            ++above;\n"
+        "    }\n"
+        "    return below + ',' + above;\n"
+        "}\n"
+        "var values = [{ v: 1 }, { v: 2.5 }, { v: -3 }, { v: NaN }, { v: '10' }, { v: '4' },\n"
+        "              { v: null }, { v: undefined }, { v: true }, { v: { valueOf: function() { return 7; } } }];\n"
+        "[count(values, { v: 3 }), count(values, { v: 3.5 }), count(values, { v: '3' }), count(values, { v: NaN })]");
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toString(), QStringLiteral("5,3"));
+    QCOMPARE(result.property(1).toString(), QStringLiteral("5,3"));
+    QCOMPARE(result.property(2).toString(), QStringLiteral("6,2"));
+    QCOMPARE(result.property(3).toString(), QStringLiteral("0,0"));
+}
+
+void tst_QJSEngine::inlineSmallFunctions()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+        "function test() {\n"
+        "    var scale = 2, calls = 0;\n"
+        "    function px(v) { return v * scale }\n"
+        "    function pair(a, b) { return a + ',' + b }\n"
+        "    function count(v) { return ++calls }\n"
+        "    function fact(n) { return n <= 1 ? 1 : n * fact(n - 1) }\n"
+        "    function shadow(scale) { return scale }\n"
+        "    function replaced() { return 'old' }\n"
+        "    var results = [px(21), pair(1), pair(1, 2, count()), calls, fact(5), shadow(7), px(shadow(3))];\n"
+        "    replaced = function() { return 'new' };\n"
+        "    results.push(replaced());\n"
+        "    return results.join(' ');\n"
+        "}\n"
+        "test()");
+    QVERIFY(!result.isError());
+    QCOMPARE(result.toString(), QStringLiteral("42 1,undefined 1,2 1 120 7 6 new"));
+
+    QJSValue notAnLValue = engine.evaluate(
+        "(function() { function f() { return 1 } f() = 2; })()");
+    QVERIFY(notAnLValue.isError());
+
+    // Code run by eval can replace the callee, also from a nested function and in strict mode.
+    QJSValue evalInNestedFunction = engine.evaluate(
+        "(function() {\n"
+        "    function sq(x) { return x * x }\n"
+        "    (function() { eval('sq = function() { return 0 }') })();\n"
+        "    return sq(3);\n"
+        "})()");
+    QVERIFY(!evalInNestedFunction.isError());
+    QCOMPARE(evalInNestedFunction.toInt(), 0);
+
+    QJSValue strictEval = engine.evaluate(
+        "(function() {\n"
+        "    'use strict';\n"
+        "    function sq(x) { return x * x }\n"
+        "    eval('sq = function() { return 0 }');\n"
+        "    return sq(3);\n"
+        "})()");
+    QVERIFY(!strictEval.isError());
+    QCOMPARE(strictEval.toInt(), 0);
+}
+
+void tst_QJSEngine::readArgumentsDirectly()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(
+        "function sum() { var s = 0; for (var i = 0; i < arguments.length; ++i) s += arguments[i]; return s; }\n"
+        "function at(a, i) { return arguments[i]; }\n"
+        "function keys(a) { return [arguments['length'], arguments['0'], arguments[1.5], typeof arguments['hasOwnProperty'], arguments['callee'] === keys]; }\n"
+        "function strictCallee() { 'use strict'; return arguments['callee']; }\n"
+        "function throwsTypeError(f) { try { f(); } catch (e) { return e instanceof TypeError; } return false; }\n"
+        "function assigned(a) { a = 3; return arguments[0]; }\n"
+        "function mapped(a) { arguments[0] = 4; return a; }\n"
+        "function count(a) { return arguments.length; }\n"
+        "[sum(1, 2, 3, 4), at(5, 0), at(5, 2), at(5, 3, 6, 7), keys(8, 9).join(','), throwsTypeError(strictCallee), assigned(1), mapped(1), count(), count(1, 2, 3)]");
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toInt(), 10);
+    QCOMPARE(result.property(1).toInt(), 5);
+    QVERIFY(result.property(2).isUndefined());
+    QCOMPARE(result.property(3).toInt(), 7);
+    QCOMPARE(result.property(4).toString(), QStringLiteral("2,8,,function,true"));
+    QCOMPARE(result.property(5).toBool(), true);
+    QCOMPARE(result.property(6).toInt(), 3);
+    QCOMPARE(result.property(7).toInt(), 4);
+    QCOMPARE(result.property(8).toInt(), 0);
+    QCOMPARE(result.property(9).toInt(), 3);
+}
+
 QTEST_MAIN(tst_QJSEngine)
 
 #include "tst_qjsengine.moc"
@@ -0,0 +1,11 @@
+import QtQuick 2.0
+
+Item {
+    property string a: typeA.origin
+    property string b: typeB.origin
+    property string c: typeC.origin
+
+    ParallelA { id: typeA }
+    ParallelB { id: typeB }
+    ParallelC { id: typeC }
+}
@@ -33,6 +33,8 @@
 
 #include <QtTest/QtTest>
 #include <QtQml/qqmlengine.h>
+#include <QtQml/qqmlcomponent.h>
+#include <QtQml/qqmlabstracturlinterceptor.h>
 #include <QtQuick/qquickview.h>
 #include <QtQuick/qquickitem.h>
 #include <QtQml/private/qqmlengine_p.h>
@@ -49,6 +51,31 @@ private slots:
     void loadComponentSynchronously();
     void trimCache();
     void trimCache2();
+    void parallelParsing_data();
+    void parallelParsing();
+    void dependencyManifest();
+    void fileCreatedAfterDirectoryListing();
+};
+
+// Redirects the QML files whose names start with "Parallel" into the "intercepted" subdirectory.
+class ParallelTypeInterceptor : public QQmlAbstractUrlInterceptor
+{
+public:
+    QUrl intercept(const QUrl &url, QQmlAbstractUrlInterceptor::DataType type)
+    {
+        if (type != QQmlAbstractUrlInterceptor::QmlFile || !url.isLocalFile())
+            return url;
+
+        QString path = url.path();
+        const int lastSlash = path.lastIndexOf(QLatin1Char('/'));
+        if (!path.midRef(lastSlash + 1).startsWith(QLatin1String("Parallel")))
+            return url;
+
+        path.insert(lastSlash, QLatin1String("/intercepted"));
+        QUrl intercepted = url;
+        intercepted.setPath(path);
+        return intercepted;
+    }
 };
 
 void tst_QQMLTypeLoader::testLoadComplete()
@@ -126,6 +153,130 @@ void tst_QQMLTypeLoader::trimCache2()
     QCOMPARE(loader.isTypeLoaded(testFileUrl("MyComponent2.qml")), false);
 }
 
+void tst_QQMLTypeLoader::parallelParsing_data()
+{
+    QTest::addColumn<bool>("intercept");
+
+    QTest::newRow("plain") << false;
+    QTest::newRow("intercepted") << true;
+}
+
+void tst_QQMLTypeLoader::parallelParsing()
+{
+    QFETCH(bool, intercept);
+
+    // The type loader reads the number of parser threads when it is created.
+    qputenv("QML_PARSER_THREADS", "4");
+    ParallelTypeInterceptor interceptor;
+    QQmlEngine engine;
+    qunsetenv("QML_PARSER_THREADS");
+    if (intercept)
+        engine.setUrlInterceptor(&interceptor);
+
+    QQmlComponent component(&engine, testFileUrl("parallelTypes.qml"));
+    QScopedPointer<QObject> o(component.create());
+    QVERIFY2(o, qPrintable(component.errorString()));
+
+    const QString prefix = intercept ? QStringLiteral("intercepted ") : QString();
+    QCOMPARE(o->property("a").toString(), prefix + QLatin1String("A"));
+    QCOMPARE(o->property("b").toString(), prefix + QLatin1String("B"));
+    QCOMPARE(o->property("c").toString(), prefix + QLatin1String("C"));
+}
+
+void tst_QQMLTypeLoader::dependencyManifest()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString manifestPath = dir.path() + QLatin1String("/dependencies");
+
+    QStringList expected;
+    expected << testFileUrl("parallelTypes.qml").toString()
+             << testFileUrl("ParallelA.qml").toString()
+             << testFileUrl("ParallelB.qml").toString()
+             << testFileUrl("ParallelC.qml").toString();
+    expected.sort();
+
+    qputenv("QML_DEPENDENCY_MANIFEST", QFile::encodeName(manifestPath));
+    qputenv("QML_PARSER_THREADS", "4");
+
+    // The first run records the manifest. It includes the types whose documents were parsed in
+    // parallel, which never reach loadThread().
+    QByteArray recorded;
+    {
+        QQmlEngine engine;
+        QQmlComponent component(&engine, testFileUrl("parallelTypes.qml"));
+        QScopedPointer<QObject> o(component.create());
+        QVERIFY2(o, qPrintable(component.errorString()));
+        QCOMPARE(o->property("a").toString(), QStringLiteral("A"));
+    }
+    {
+        QFile manifest(manifestPath);
+        QVERIFY(manifest.open(QFile::ReadOnly | QFile::Text));
+        recorded = manifest.readAll();
+    }
+    QStringList urls = QString::fromUtf8(recorded).split(QLatin1Char('\n'), QString::SkipEmptyParts);
+    urls.sort();
+    QCOMPARE(urls, expected);
+
+    // The second run prefetches the documents listed in the manifest and leaves it alone.
+    {
+        QQmlEngine engine;
+        QQmlComponent component(&engine, testFileUrl("parallelTypes.qml"));
+        QScopedPointer<QObject> o(component.create());
+        QVERIFY2(o, qPrintable(component.errorString()));
+        QCOMPARE(o->property("a").toString(), QStringLiteral("A"));
+        QCOMPARE(o->property("b").toString(), QStringLiteral("B"));
+        QCOMPARE(o->property("c").toString(), QStringLiteral("C"));
+    }
+    {
+        QFile manifest(manifestPath);
+        QVERIFY(manifest.open(QFile::ReadOnly | QFile::Text));
+        QCOMPARE(manifest.readAll(), recorded);
+    }
+
+    qunsetenv("QML_DEPENDENCY_MANIFEST");
+    qunsetenv("QML_PARSER_THREADS");
+}
+
+static bool writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    return file.open(QFile::WriteOnly) && file.write(contents) == contents.size();
+}
+
+void tst_QQMLTypeLoader::fileCreatedAfterDirectoryListing()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QByteArray contents("import QtQuick 2.0\nItem {}\n");
+    const QString existing = dir.path() + QLatin1String("/Existing.qml");
+    const QString created = dir.path() + QLatin1String("/Created.qml");
+    QVERIFY(writeFile(existing, contents));
+
+    QQmlEngine engine;
+    QQmlTypeLoader &loader = QQmlEnginePrivate::get(&engine)->typeLoader;
+
+    // Looking up a file caches the listing of its directory.
+    QVERIFY(loader.directoryExists(dir.path()));
+    QCOMPARE(loader.absoluteFilePath(existing), existing);
+
+    // Files created after the directory was listed are found once the listing is dropped.
+    QVERIFY(writeFile(created, contents));
+    loader.clearDirectoryCache();
+    QCOMPARE(loader.absoluteFilePath(created), created);
+    QCOMPARE(loader.absoluteFilePath(existing), existing);
+
+    // Clearing the component cache drops it as well.
+    QVERIFY(writeFile(dir.path() + QLatin1String("/Later.qml"), contents));
+    engine.clearComponentCache();
+
+    QQmlComponent component(&engine);
+    component.setData("import QtQuick 2.0\nItem { Created {} Later {} }\n",
+                      QUrl::fromLocalFile(dir.path() + QLatin1String("/main.qml")));
+    QScopedPointer<QObject> o(component.create());
+    QVERIFY2(o, qPrintable(component.errorString()));
+}
+
 QTEST_MAIN(tst_QQMLTypeLoader)
 
 #include "tst_qqmltypeloader.moc"
@@ -34,6 +34,10 @@
 #include <qtest.h>
 
 #include <private/qv4ssa_p.h>
+#include <private/qv4codegen_p.h>
+#include <private/qqmljsengine_p.h>
+#include <private/qqmljslexer_p.h>
+#include <private/qqmljsparser_p.h>
 
 class tst_v4misc: public QObject
 {
@@ -45,6 +49,9 @@ private slots:
     void rangeSplitting_1();
     void rangeSplitting_2();
     void rangeSplitting_3();
+
+    void containsLoop_data();
+    void containsLoop();
 };
 
 QT_BEGIN_NAMESPACE
@@ -144,6 +151,51 @@ void tst_v4misc::rangeSplitting_3()
     QCOMPARE(interval.end(), 71);
 }
 
+void tst_v4misc::containsLoop_data()
+{
+    QTest::addColumn<QString>("body");
+    QTest::addColumn<bool>("loop");
+
+    QTest::newRow("straight") << "x = a + b; return x;" << false;
+    QTest::newRow("nested ifs") << "if (a) { if (b) x = 1; else x = 2; } else if (c) { x = 3; } return x;" << false;
+    QTest::newRow("logical and") << "if (a && b) x = 1; return x;" << false;
+    QTest::newRow("logical or and and") << "if ((a || b) && c) { if (b && c) x = 1; } return x;" << false;
+    QTest::newRow("conditional") << "return a && b ? (c || a) : b;" << false;
+    QTest::newRow("switch") << "switch (a) { case 1: x = 1; break; case 2: x = 2; default: x = 3; } return x;" << false;
+    QTest::newRow("try") << "try { x = a(); } catch (e) { x = b; } finally { c = 1; } return x;" << false;
+    QTest::newRow("while") << "while (a) a = a - 1; return a;" << true;
+    QTest::newRow("for with break") << "for (var i = 0; i < 10; ++i) { if (i == b && c) break; } return i;" << true;
+    QTest::newRow("do while") << "do { a = a - 1; } while (a > 0 && b); return a;" << true;
+    QTest::newRow("for in") << "for (x in a) b = x; return b;" << true;
+}
+
+void tst_v4misc::containsLoop()
+{
+    QFETCH(QString, body);
+    QFETCH(bool, loop);
+
+    const QString source = QLatin1String("function f(a, b, c) { var x; ") + body + QLatin1String(" }");
+    QQmlJS::Engine engine;
+    QQmlJS::Lexer lexer(&engine);
+    lexer.setCode(source, /*line*/1, /*qml mode*/false);
+    QQmlJS::Parser parser(&engine);
+    QVERIFY(parser.parseProgram());
+    QQmlJS::AST::Program *program = QQmlJS::AST::cast<QQmlJS::AST::Program *>(parser.rootNode());
+    QVERIFY(program);
+
+    Module module(/*debugMode*/false);
+    QQmlJS::Codegen codegen(/*strict mode*/false);
+    codegen.generateFromProgram(QStringLiteral("containsLoop.js"), source, program, &module);
+
+    Function *function = 0;
+    foreach (Function *f, module.functions) {
+        if (f->name && *f->name == QLatin1String("f"))
+            function = f;
+    }
+    QVERIFY(function);
+    QCOMPARE(QV4::IR::containsLoop(function), loop);
+}
+
 QTEST_MAIN(tst_v4misc)
 
 #include "tst_v4misc.moc"
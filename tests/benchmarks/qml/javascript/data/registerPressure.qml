@@ -0,0 +1,28 @@
+// Benchmarks a loop that keeps more numbers alive than there are registers, so the JIT has to
+// spill. The values come from parameters, so constant propagation can't fold them away. Run with
+// QV4_SHOW_IR=1 to see the spill stores, reloads and rematerialized constants per function, and
+// the size of the generated code.
+
+import QtQuick 2.0
+
+QtObject {
+    function compute(pa, pb, pc, pd, pe, pf, pg, ph, pi, pj, pk, pl, pm, pn, po, pp) {
+        var a = +pa, b = +pb, c = +pc, d = +pd, e = +pe, f = +pf, g = +pg, h = +ph;
+        var i = +pi, j = +pj, k = +pk, l = +pl, m = +pm, n = +pn, o = +po, p = +pp;
+        var sum = 0;
+        for (var ii = 0; ii < 1000000; ++ii) {
+            var x = ii * 0.5;
+            sum += a * x + b;
+            sum -= c * d + e * x;
+            sum += f * g - h * x;
+            sum -= i * j + k * x;
+            sum += l * m - n * x;
+            sum += o * p + x;
+        }
+        return sum;
+    }
+
+    function runtest() {
+        return compute(1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5, 9.5, 10.5, 11.5, 12.5, 13.5, 14.5, 15.5, 16.5);
+    }
+}